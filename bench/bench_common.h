@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Shared helpers for the benchmark executables
+ */
+namespace bench {
+
+using Clock = std::chrono::high_resolution_clock;
+
+/**
+ * @brief Latency distribution of a set of samples (milliseconds)
+ */
+struct LatencyStats {
+    int samples = 0;
+    double minMs = 0.0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p90Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+/**
+ * @brief Parse a decimal command-line integer within [minValue, maxValue]
+ * @return false for signs, non-digits, overflow or out-of-range values
+ */
+inline bool parseUnsigned(const std::string& text, uint64_t minValue, uint64_t maxValue, uint64_t& value) {
+    // stoull would accept "-1" (wrapping) and trailing garbage, so only plain digits get through
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    try {
+        const unsigned long long parsed = std::stoull(text);
+        if (parsed < minValue || parsed > maxValue) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    } catch (const std::invalid_argument&) {
+        return false;
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+}
+
+inline double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/**
+ * @brief Nearest-rank percentile of an ascending-sorted sample set
+ */
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size()) + 0.5);
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+inline LatencyStats computeStats(std::vector<double> samplesMs) {
+    LatencyStats stats;
+    stats.samples = static_cast<int>(samplesMs.size());
+    if (samplesMs.empty()) return stats;
+
+    std::sort(samplesMs.begin(), samplesMs.end());
+
+    double total = 0.0;
+    for (double s : samplesMs) total += s;
+
+    stats.minMs = samplesMs.front();
+    stats.maxMs = samplesMs.back();
+    stats.meanMs = total / static_cast<double>(samplesMs.size());
+    stats.p50Ms = percentile(samplesMs, 50.0);
+    stats.p90Ms = percentile(samplesMs, 90.0);
+    stats.p99Ms = percentile(samplesMs, 99.0);
+    return stats;
+}
+
+} // namespace bench
@@ -0,0 +1,469 @@
+#include "gl_context.h"
+#include "nn_buffers.h"
+#include "nn_compute.h"
+#include "cpu_reference.h"
+#include "quantized_network.h"
+#include "static_network.h"
+#include "bench_common.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * NeuraVis Benchmark Suite
+ *
+ * Reproduces the README performance targets:
+ * - Small  (784 -> 128 -> 10)
+ * - Medium (784 -> 512 -> 256 -> 10)
+ * - Large  (784 -> 1024 -> 512 -> 256 -> 10)
+ *
+ * Backends:
+ * - gpu:          setInputs + NeuralCompute::forward + readOutputs per inference
+ * - gpu-dispatch: NeuralCompute::forward only, one glFinish per batch
+ * - cpu:          CpuReference::forward per inference
+ * - cpu-int8:     QuantizedNetwork::forward per inference (calibrated on the bench inputs;
+ *                build with -march=native to get the VNNI kernel)
+ * - static:       StaticNetwork::forward per inference, on the XOR network (2 -> 2 -> 1)
+ *                only, next to a cpu run of the same network
+ *
+ * A "batch" is N inferences issued back to back; latency is measured per batch.
+ *
+ * Usage:
+ *   neuravis_bench [--format json|csv] [--out FILE] [--iterations N]
+ *                  [--warmup N] [--batches 1,8,64]
+ *                  [--weight-layout row|input|tiled4] [--pad-vec4]
+ *                  [--reuse-activations]
+ */
+
+namespace {
+
+struct BenchTopology {
+    std::string name;
+    std::vector<uint32_t> layers;
+};
+
+struct BenchOptions {
+    std::string format = "json";
+    std::string outPath;
+    int iterations = 50;
+    int warmup = 5;
+    std::vector<uint32_t> batchSizes = {1, 8, 64};
+    NeuralBuffers::WeightLayout weightLayout = NeuralBuffers::WeightLayout::RowMajor;
+    bool padToVec4 = false;
+    bool reuseActivations = false;
+};
+
+struct BenchResult {
+    std::string topology;
+    std::string backend;
+    uint32_t batchSize = 0;
+    bench::LatencyStats latency;
+    double gpuMs = 0.0;              // GPU timer query time per batch (gpu-dispatch only)
+    double throughput = 0.0;         // Inferences per second (from mean latency)
+    double speedupVsCpu = 0.0;       // p50 CPU latency / p50 latency for same topology + batch
+};
+
+using bench::Clock;
+using bench::elapsedMs;
+
+BenchResult summarize(const std::string& topology, const std::string& backend,
+                      uint32_t batchSize, const std::vector<double>& samplesMs) {
+    BenchResult r;
+    r.topology = topology;
+    r.backend = backend;
+    r.batchSize = batchSize;
+    r.latency = bench::computeStats(samplesMs);
+    r.throughput = r.latency.meanMs > 0.0 ? batchSize * 1000.0 / r.latency.meanMs : 0.0;
+    return r;
+}
+
+// Deterministic Xavier-uniform parameters so runs are comparable
+void generateParameters(const std::vector<uint32_t>& layers,
+                        std::vector<float>& weights, std::vector<float>& biases) {
+    std::mt19937 rng(1234);
+    weights.clear();
+    biases.clear();
+
+    for (size_t i = 0; i + 1 < layers.size(); ++i) {
+        float limit = std::sqrt(6.0f / static_cast<float>(layers[i] + layers[i + 1]));
+        std::uniform_real_distribution<float> dist(-limit, limit);
+        for (uint32_t w = 0; w < layers[i] * layers[i + 1]; ++w) {
+            weights.push_back(dist(rng));
+        }
+        for (uint32_t b = 0; b < layers[i + 1]; ++b) {
+            biases.push_back(0.01f);
+        }
+    }
+}
+
+std::vector<std::vector<float>> generateInputs(uint32_t inputSize, uint32_t count) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    std::vector<std::vector<float>> inputs(count, std::vector<float>(inputSize));
+    for (auto& input : inputs) {
+        for (float& v : input) v = dist(rng);
+    }
+    return inputs;
+}
+
+void benchmarkTopology(const BenchTopology& topo, const BenchOptions& options,
+                       std::vector<BenchResult>& results) {
+    std::cout << "[BENCH] " << topo.name << "\n";
+
+    // ReLU hidden layers, linear output
+    std::vector<uint32_t> activations(topo.layers.size() - 1, 0);
+    activations.back() = 3;
+
+    std::vector<float> weights, biases;
+    generateParameters(topo.layers, weights, biases);
+
+    NeuralBuffers buffers;
+    NeuralBuffers::Config bufferConfig;
+    bufferConfig.weightLayout = options.weightLayout;
+    bufferConfig.padToVec4 = options.padToVec4;
+    bufferConfig.reuseActivations = options.reuseActivations;
+    buffers.setConfig(bufferConfig);
+    if (!buffers.initialize(topo.layers, activations)) {
+        std::cerr << "[ERROR] Failed to initialize buffers for " << topo.name << "\n";
+        return;
+    }
+    buffers.uploadWeights(weights);
+    buffers.uploadBiases(biases);
+
+    NeuralCompute compute;
+    if (!compute.initialize("shaders/forward.comp", buffers)) {
+        std::cerr << "[ERROR] Failed to initialize compute for " << topo.name << "\n";
+        return;
+    }
+
+    CpuReference cpu;
+    cpu.initialize(topo.layers, activations);
+    cpu.setWeights(weights);
+    cpu.setBiases(biases);
+
+    uint32_t maxBatch = *std::max_element(options.batchSizes.begin(), options.batchSizes.end());
+    auto inputs = generateInputs(topo.layers[0], maxBatch);
+    std::vector<float> outputs;
+
+    QuantizedNetwork cpuInt8;
+    cpuInt8.initialize(topo.layers, activations);
+    cpuInt8.setWeights(weights);
+    cpuInt8.setBiases(biases);
+    cpuInt8.calibrate(inputs);
+
+    for (uint32_t batch : options.batchSizes) {
+        size_t firstResult = results.size();
+
+        // --- gpu: full request path (upload, dispatch, readback) ---
+        {
+            std::vector<double> samples;
+            for (int it = 0; it < options.warmup + options.iterations; ++it) {
+                auto start = Clock::now();
+                for (uint32_t b = 0; b < batch; ++b) {
+                    buffers.setInputs(inputs[b]);
+                    compute.forward();
+                    buffers.readOutputs(outputs);
+                }
+                auto end = Clock::now();
+                if (it >= options.warmup) {
+                    samples.push_back(elapsedMs(start, end));
+                }
+            }
+            results.push_back(summarize(topo.name, "gpu", batch, samples));
+        }
+
+        // --- gpu-dispatch: compute only, synchronized once per batch ---
+        // (with --reuse-activations later passes read an overwritten input; only timing matters)
+        {
+            std::vector<double> samples;
+            buffers.setInputs(inputs[0]);
+            for (int it = 0; it < options.warmup + options.iterations; ++it) {
+                glFinish();
+                auto start = Clock::now();
+                for (uint32_t b = 0; b < batch; ++b) {
+                    compute.forward();
+                }
+                glFinish();
+                auto end = Clock::now();
+                if (it >= options.warmup) {
+                    samples.push_back(elapsedMs(start, end));
+                }
+            }
+            BenchResult r = summarize(topo.name, "gpu-dispatch", batch, samples);
+
+            // Separate profiled pass: timer queries block per forward(), so they
+            // must not be mixed into the wall-clock samples above
+            compute.setProfilingEnabled(true);
+            double gpuTotalMs = 0.0;
+            for (int it = 0; it < options.iterations; ++it) {
+                compute.forward();
+                gpuTotalMs += compute.getLastExecutionTime();
+            }
+            compute.setProfilingEnabled(false);
+            r.gpuMs = gpuTotalMs / options.iterations * batch;
+            results.push_back(r);
+        }
+
+        // --- cpu: reference implementation ---
+        {
+            std::vector<double> samples;
+            for (int it = 0; it < options.warmup + options.iterations; ++it) {
+                auto start = Clock::now();
+                for (uint32_t b = 0; b < batch; ++b) {
+                    cpu.forward(inputs[b], outputs);
+                }
+                auto end = Clock::now();
+                if (it >= options.warmup) {
+                    samples.push_back(elapsedMs(start, end));
+                }
+            }
+            results.push_back(summarize(topo.name, "cpu", batch, samples));
+        }
+
+        // --- cpu-int8: quantized weights and activations ---
+        {
+            std::vector<double> samples;
+            for (int it = 0; it < options.warmup + options.iterations; ++it) {
+                auto start = Clock::now();
+                for (uint32_t b = 0; b < batch; ++b) {
+                    cpuInt8.forward(inputs[b], outputs);
+                }
+                auto end = Clock::now();
+                if (it >= options.warmup) {
+                    samples.push_back(elapsedMs(start, end));
+                }
+            }
+            results.push_back(summarize(topo.name, "cpu-int8", batch, samples));
+        }
+
+        // Speedup relative to the CPU reference for this topology + batch
+        double cpuP50 = 0.0;
+        for (size_t i = firstResult; i < results.size(); ++i) {
+            if (results[i].backend == "cpu") cpuP50 = results[i].latency.p50Ms;
+        }
+        for (size_t i = firstResult; i < results.size(); ++i) {
+            const double p50 = results[i].latency.p50Ms;
+            results[i].speedupVsCpu = p50 > 0.0 ? cpuP50 / p50 : 0.0;
+        }
+
+        std::cout << "  batch " << batch << " done\n";
+    }
+}
+
+// Compile-time topology: XOR only, since StaticNetwork caps out at a few thousand weights
+void benchmarkStatic(const BenchOptions& options, std::vector<BenchResult>& results) {
+    const std::string name = "xor_2-2-1";
+    std::cout << "[BENCH] " << name << "\n";
+
+    const std::vector<float> weights = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -2.0f};
+    const std::vector<float> biases = {0.0f, -1.0f, 0.0f};
+
+    StaticNetwork<StaticActivations<0, 3>, 2, 2, 1> net;
+    net.setWeights(weights);
+    net.setBiases(biases);
+
+    CpuReference cpu;
+    cpu.initialize({2, 2, 1}, {0, 3});
+    cpu.setWeights(weights);
+    cpu.setBiases(biases);
+
+    uint32_t maxBatch = *std::max_element(options.batchSizes.begin(), options.batchSizes.end());
+    auto inputs = generateInputs(2, maxBatch);
+    std::vector<std::array<float, 2>> staticInputs(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        staticInputs[i] = {inputs[i][0], inputs[i][1]};
+    }
+    std::vector<float> outputs;
+    volatile float sink = 0.0f;     // Keeps the unrolled forward() from being optimized away
+
+    for (uint32_t batch : options.batchSizes) {
+        std::vector<double> cpuSamples, staticSamples;
+        for (int it = 0; it < options.warmup + options.iterations; ++it) {
+            auto start = Clock::now();
+            for (uint32_t b = 0; b < batch; ++b) {
+                cpu.forward(inputs[b], outputs);
+            }
+            auto mid = Clock::now();
+            for (uint32_t b = 0; b < batch; ++b) {
+                sink = sink + net.forward(staticInputs[b])[0];
+            }
+            auto end = Clock::now();
+            if (it >= options.warmup) {
+                cpuSamples.push_back(elapsedMs(start, mid));
+                staticSamples.push_back(elapsedMs(mid, end));
+            }
+        }
+
+        BenchResult cpuResult = summarize(name, "cpu", batch, cpuSamples);
+        BenchResult staticResult = summarize(name, "static", batch, staticSamples);
+        cpuResult.speedupVsCpu = 1.0;
+        staticResult.speedupVsCpu =
+            staticResult.latency.p50Ms > 0.0 ? cpuResult.latency.p50Ms / staticResult.latency.p50Ms : 0.0;
+        results.push_back(cpuResult);
+        results.push_back(staticResult);
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"topology\": \"" << r.topology << "\""
+            << ", \"backend\": \"" << r.backend << "\""
+            << ", \"batch\": " << r.batchSize
+            << ", \"samples\": " << r.latency.samples
+            << ", \"min_ms\": " << r.latency.minMs
+            << ", \"mean_ms\": " << r.latency.meanMs
+            << ", \"p50_ms\": " << r.latency.p50Ms
+            << ", \"p90_ms\": " << r.latency.p90Ms
+            << ", \"p99_ms\": " << r.latency.p99Ms
+            << ", \"max_ms\": " << r.latency.maxMs
+            << ", \"gpu_ms\": " << r.gpuMs
+            << ", \"throughput_per_s\": " << r.throughput
+            << ", \"speedup_vs_cpu\": " << r.speedupVsCpu << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void writeCsv(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "topology,backend,batch,samples,min_ms,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,"
+           "gpu_ms,throughput_per_s,speedup_vs_cpu\n";
+    for (const auto& r : results) {
+        const auto& l = r.latency;
+        out << r.topology << "," << r.backend << "," << r.batchSize << "," << l.samples << ","
+            << l.minMs << "," << l.meanMs << "," << l.p50Ms << "," << l.p90Ms << ","
+            << l.p99Ms << "," << l.maxMs << "," << r.gpuMs << "," << r.throughput << ","
+            << r.speedupVsCpu << "\n";
+    }
+}
+
+bool parseArgs(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--format" && hasValue) {
+            options.format = argv[++i];
+        } else if (arg == "--out" && hasValue) {
+            options.outPath = argv[++i];
+        } else if (arg == "--iterations" && hasValue) {
+            uint64_t iterations = 0;
+            if (!bench::parseUnsigned(argv[++i], 1, INT_MAX, iterations)) {
+                std::cerr << "[ERROR] --iterations must be between 1 and " << INT_MAX << "\n";
+                return false;
+            }
+            options.iterations = static_cast<int>(iterations);
+        } else if (arg == "--warmup" && hasValue) {
+            uint64_t warmup = 0;
+            if (!bench::parseUnsigned(argv[++i], 0, INT_MAX, warmup)) {
+                std::cerr << "[ERROR] --warmup must be between 0 and " << INT_MAX << "\n";
+                return false;
+            }
+            options.warmup = static_cast<int>(warmup);
+        } else if (arg == "--weight-layout" && hasValue) {
+            std::string layout = argv[++i];
+            if (layout == "row") {
+                options.weightLayout = NeuralBuffers::WeightLayout::RowMajor;
+            } else if (layout == "input") {
+                options.weightLayout = NeuralBuffers::WeightLayout::InputMajor;
+            } else if (layout == "tiled4") {
+                options.weightLayout = NeuralBuffers::WeightLayout::Tiled4;
+            } else {
+                std::cerr << "[ERROR] --weight-layout must be row, input or tiled4\n";
+                return false;
+            }
+        } else if (arg == "--pad-vec4") {
+            options.padToVec4 = true;
+        } else if (arg == "--reuse-activations") {
+            options.reuseActivations = true;
+        } else if (arg == "--batches" && hasValue) {
+            options.batchSizes.clear();
+            std::stringstream ss(argv[++i]);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                if (item.empty()) continue;
+                uint64_t size = 0;
+                if (!bench::parseUnsigned(item, 1, UINT32_MAX, size)) {
+                    std::cerr << "[ERROR] --batches sizes must be between 1 and " << UINT32_MAX << "\n";
+                    return false;
+                }
+                options.batchSizes.push_back(static_cast<uint32_t>(size));
+            }
+        } else {
+            std::cerr << "[ERROR] Unknown or incomplete argument: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (options.format != "json" && options.format != "csv") {
+        std::cerr << "[ERROR] --format must be json or csv\n";
+        return false;
+    }
+    if (options.batchSizes.empty()) {
+        std::cerr << "[ERROR] --batches needs at least one size\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        return 1;
+    }
+
+    // Hidden window: we only need a context, and VSync must not throttle us
+    GLContext context;
+    GLContext::Config config;
+    config.title = "NeuraVis Benchmark";
+    config.visible = false;
+    config.enableVSync = false;
+    config.enableDebugOutput = false;
+
+    if (!context.initialize(config)) {
+        std::cerr << "[ERROR] Failed to initialize OpenGL context\n";
+        return 1;
+    }
+
+    const std::vector<BenchTopology> topologies = {
+        {"small_784-128-10", {784, 128, 10}},
+        {"medium_784-512-256-10", {784, 512, 256, 10}},
+        {"large_784-1024-512-256-10", {784, 1024, 512, 256, 10}},
+    };
+
+    std::vector<BenchResult> results;
+    for (const auto& topo : topologies) {
+        benchmarkTopology(topo, options, results);
+    }
+    benchmarkStatic(options, results);
+
+    std::ofstream file;
+    if (!options.outPath.empty()) {
+        file.open(options.outPath);
+        if (!file.is_open()) {
+            std::cerr << "[ERROR] Failed to open output file: " << options.outPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = file.is_open() ? static_cast<std::ostream&>(file) : std::cout;
+
+    if (options.format == "csv") {
+        writeCsv(out, results);
+    } else {
+        writeJson(out, results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,266 @@
+#include "gl_context.h"
+#include "nn_buffers.h"
+#include "bench_common.h"
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * NeuraVis Upload Path Microbenchmarks
+ *
+ * Compares NeuralBuffers::UploadStrategy (SubData, MapRange, Orphan, PersistentMap)
+ * on the three real upload paths:
+ * - weights:     NeuralBuffers::uploadWeights     (topology {1, N})
+ * - inputs:      NeuralBuffers::setInputs         (topology {N, 1})
+ * - activations: NeuralBuffers::uploadActivations (topology {N - 1, 1})
+ *
+ * Payload sizes range from 8 bytes to 256 MB. Two timings are reported per sample:
+ * - call_ms:     time spent inside the upload call (what the render loop pays)
+ * - complete_ms: call + glFinish (when the data is actually resident)
+ *
+ * The summary at the end lists the fastest strategy per path for tiny
+ * (<= 64 KB) and bulk (> 64 KB) payloads; use it to choose
+ * NeuralBuffers::Config::uploadStrategy. Every sample starts from an idle GPU (glFinish),
+ * which hides the per-upload queue drain of PersistentMap; weigh it accordingly for
+ * uploads issued while dispatches are in flight. Cases whose buffers fail to initialize
+ * (e.g. --max-bytes above the SSBO limit) are skipped with a warning.
+ *
+ * Usage:
+ *   neuravis_upload_bench [--format json|csv] [--out FILE] [--max-bytes N]
+ *
+ * --max-bytes must be a multiple of 4 (whole floats), at most 4 * UINT32_MAX.
+ */
+
+namespace {
+
+using bench::Clock;
+using bench::elapsedMs;
+using Strategy = NeuralBuffers::UploadStrategy;
+
+struct UploadResult {
+    std::string path;
+    std::string strategy;
+    size_t bytes = 0;
+    bench::LatencyStats call;
+    bench::LatencyStats complete;
+    double throughputGBs = 0.0;      // From complete p50
+};
+
+const char* strategyName(Strategy strategy) {
+    switch (strategy) {
+        case Strategy::SubData:       return "subdata";
+        case Strategy::MapRange:      return "map_range";
+        case Strategy::Orphan:        return "orphan";
+        case Strategy::PersistentMap: return "persistent_map";
+    }
+    return "unknown";
+}
+
+std::vector<size_t> payloadSizes(size_t maxBytes) {
+    // 8 B, 32 B, 128 B, ... in 4x steps, always ending at maxBytes
+    std::vector<size_t> sizes;
+    for (size_t bytes = 8; bytes < maxBytes; bytes *= 4) {
+        sizes.push_back(bytes);
+    }
+    sizes.push_back(maxBytes);
+    return sizes;
+}
+
+int iterationsFor(size_t bytes) {
+    // Keep total runtime bounded for the large payloads
+    if (bytes >= 64u << 20) return 5;
+    if (bytes >= 4u << 20) return 20;
+    return 200;
+}
+
+// Returns false (and leaves r untouched) when the buffers for this size cannot be created
+bool runCase(const std::string& path, Strategy strategy, size_t bytes, UploadResult& r) {
+    const uint32_t count = static_cast<uint32_t>(bytes / sizeof(float));
+
+    std::vector<uint32_t> topology;
+    if (path == "weights") {
+        topology = {1, count};
+    } else if (path == "inputs") {
+        topology = {count, 1};
+    } else {
+        topology = {count - 1, 1};
+    }
+
+    NeuralBuffers buffers;
+    NeuralBuffers::Config config;
+    config.uploadStrategy = strategy;
+    buffers.setConfig(config);
+    if (!buffers.initialize(topology, {3})) {
+        return false;
+    }
+
+    std::vector<float> payload(count, 0.5f);
+    const int warmup = 2;
+    const int iterations = iterationsFor(bytes);
+
+    std::vector<double> callSamples, completeSamples;
+    for (int it = 0; it < warmup + iterations; ++it) {
+        payload[0] = static_cast<float>(it);  // Defeat any driver-side redundancy checks
+        glFinish();
+
+        auto start = Clock::now();
+        if (path == "weights") {
+            buffers.uploadWeights(payload);
+        } else if (path == "inputs") {
+            buffers.setInputs(payload);
+        } else {
+            buffers.uploadActivations(payload);
+        }
+        auto called = Clock::now();
+        glFinish();
+        auto done = Clock::now();
+
+        if (it >= warmup) {
+            callSamples.push_back(elapsedMs(start, called));
+            completeSamples.push_back(elapsedMs(start, done));
+        }
+    }
+
+    r.path = path;
+    r.strategy = strategyName(strategy);
+    r.bytes = static_cast<size_t>(count) * sizeof(float);
+    r.call = bench::computeStats(callSamples);
+    r.complete = bench::computeStats(completeSamples);
+    r.throughputGBs = r.complete.p50Ms > 0.0 ? r.bytes / (r.complete.p50Ms * 1.0e6) : 0.0;
+    return true;
+}
+
+void writeJson(std::ostream& out, const std::vector<UploadResult>& results) {
+    out << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"path\": \"" << r.path << "\""
+            << ", \"strategy\": \"" << r.strategy << "\""
+            << ", \"bytes\": " << r.bytes
+            << ", \"samples\": " << r.complete.samples
+            << ", \"call_p50_ms\": " << r.call.p50Ms
+            << ", \"call_p99_ms\": " << r.call.p99Ms
+            << ", \"complete_p50_ms\": " << r.complete.p50Ms
+            << ", \"complete_p90_ms\": " << r.complete.p90Ms
+            << ", \"complete_p99_ms\": " << r.complete.p99Ms
+            << ", \"throughput_gb_s\": " << r.throughputGBs << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void writeCsv(std::ostream& out, const std::vector<UploadResult>& results) {
+    out << "path,strategy,bytes,samples,call_p50_ms,call_p99_ms,"
+           "complete_p50_ms,complete_p90_ms,complete_p99_ms,throughput_gb_s\n";
+    for (const auto& r : results) {
+        out << r.path << "," << r.strategy << "," << r.bytes << "," << r.complete.samples << ","
+            << r.call.p50Ms << "," << r.call.p99Ms << ","
+            << r.complete.p50Ms << "," << r.complete.p90Ms << "," << r.complete.p99Ms << ","
+            << r.throughputGBs << "\n";
+    }
+}
+
+void printRecommendation(const std::vector<UploadResult>& results) {
+    constexpr size_t kTinyLimit = 64 * 1024;
+
+    // (path, bucket) -> strategy -> summed complete p50
+    std::map<std::pair<std::string, std::string>, std::map<std::string, double>> totals;
+    for (const auto& r : results) {
+        std::string bucket = r.bytes <= kTinyLimit ? "tiny" : "bulk";
+        totals[{r.path, bucket}][r.strategy] += r.complete.p50Ms;
+    }
+
+    std::cerr << "\n[RESULT] Fastest upload strategy (sum of complete p50 per bucket):\n";
+    for (const auto& [key, byStrategy] : totals) {
+        auto best = byStrategy.begin();
+        for (auto it = byStrategy.begin(); it != byStrategy.end(); ++it) {
+            if (it->second < best->second) best = it;
+        }
+        std::cerr << "  " << key.first << " (" << key.second << "): " << best->first << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string format = "json";
+    std::string outPath;
+    size_t maxBytes = 256u << 20;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--max-bytes" && i + 1 < argc) {
+            // Whole floats only, and the float count must fit the uint32 topology sizes
+            uint64_t value = 0;
+            if (!bench::parseUnsigned(argv[++i], 8, static_cast<uint64_t>(UINT32_MAX) * sizeof(float), value) ||
+                value % sizeof(float) != 0) {
+                std::cerr << "[ERROR] --max-bytes must be a multiple of 4 between 8 and "
+                          << static_cast<uint64_t>(UINT32_MAX) * sizeof(float) << "\n";
+                return 1;
+            }
+            maxBytes = static_cast<size_t>(value);
+        } else {
+            std::cerr << "[ERROR] Unknown or incomplete argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    GLContext context;
+    GLContext::Config config;
+    config.title = "NeuraVis Upload Benchmark";
+    config.visible = false;
+    config.enableVSync = false;
+    config.enableDebugOutput = false;
+
+    if (!context.initialize(config)) {
+        std::cerr << "[ERROR] Failed to initialize OpenGL context\n";
+        return 1;
+    }
+
+    const std::vector<std::string> paths = {"weights", "inputs", "activations"};
+    const std::vector<Strategy> strategies = {
+        Strategy::SubData, Strategy::MapRange, Strategy::Orphan, Strategy::PersistentMap
+    };
+
+    std::vector<UploadResult> results;
+    for (size_t bytes : payloadSizes(maxBytes)) {
+        for (const auto& path : paths) {
+            for (Strategy strategy : strategies) {
+                UploadResult r;
+                if (runCase(path, strategy, bytes, r)) {
+                    results.push_back(r);
+                } else {
+                    // Skipped cases stay out of the results and the recommendation
+                    std::cerr << "[WARNING] Skipping " << path << " / " << strategyName(strategy)
+                              << " at " << bytes << " bytes: buffers failed to initialize\n";
+                }
+            }
+        }
+        std::cerr << "[BENCH] " << bytes << " bytes done\n";
+    }
+
+    std::ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath);
+        if (!file.is_open()) {
+            std::cerr << "[ERROR] Failed to open output file: " << outPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = file.is_open() ? static_cast<std::ostream&>(file) : std::cout;
+
+    if (format == "csv") {
+        writeCsv(out, results);
+    } else {
+        writeJson(out, results);
+    }
+
+    printRecommendation(results);
+    return 0;
+}
@@ -2,6 +2,7 @@
 
 // Input
 layout(location = 0) in vec3 a_position;  // 3D position from VBO
+layout(location = 1) in uint a_activationIndex;  // Slot in the activations SSBO
 
 // Uniforms
 uniform mat4 u_view;
@@ -19,7 +20,7 @@ layout(std430, binding = 2) readonly buffer ActivationsBuffer {
 
 void main() {
     // Read activation value for this neuron
-    v_activation = activationsData.activations[gl_VertexID];
+    v_activation = activationsData.activations[a_activationIndex];
 
     // Pass position to fragment shader
     v_position = a_position;
@@ -0,0 +1,395 @@
+#include "cpu_reference.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+bool CpuReference::initialize(const std::vector<uint32_t>& layerSizes,
+                              const std::vector<uint32_t>& activations) {
+    if (layerSizes.size() < 2 || activations.size() != layerSizes.size() - 1) {
+        std::cerr << "[ERROR] CpuReference: invalid topology\n";
+        return false;
+    }
+
+    TensorShape inputShape;
+    inputShape.channels = layerSizes[0];
+
+    std::vector<LayerDesc> layers;
+    for (size_t i = 0; i < activations.size(); ++i) {
+        layers.push_back(LayerDesc::dense(layerSizes[i + 1], activations[i]));
+    }
+    return initialize(inputShape, layers);
+}
+
+bool CpuReference::initialize(const TensorShape& inputShape, const std::vector<LayerDesc>& layers) {
+    if (layers.empty()) {
+        std::cerr << "[ERROR] CpuReference: invalid topology\n";
+        return false;
+    }
+
+    m_shapes = {inputShape};
+    m_layers = layers;
+    m_activationTypes.clear();
+    m_weightStart.clear();
+    m_totalWeights = 0;
+    m_totalBiases = 0;
+    for (const LayerDesc& desc : layers) {
+        const TensorShape out = layerOutputShape(m_shapes.back(), desc);
+        if (out.size() == 0) {
+            std::cerr << "[ERROR] CpuReference: layer produces an empty output\n";
+            return false;
+        }
+        if (desc.residualFrom >= 0 && (static_cast<size_t>(desc.residualFrom) >= m_shapes.size() ||
+                                       m_shapes[desc.residualFrom].size() != out.size())) {
+            std::cerr << "[ERROR] CpuReference: residual source must be an earlier layer of the same size\n";
+            return false;
+        }
+        if (desc.tiedTo >= 0) {
+            const size_t source = static_cast<size_t>(desc.tiedTo);
+            const bool fits = source + 1 < m_shapes.size() && m_layers[source].kind == LayerKind::Dense &&
+                              m_layers[source].tiedTo < 0 && desc.kind == LayerKind::Dense &&
+                              m_shapes[source].size() == (desc.tiedTransposed ? out.size() : m_shapes.back().size()) &&
+                              m_shapes[source + 1].size() == (desc.tiedTransposed ? m_shapes.back().size() : out.size());
+            if (!fits) {
+                std::cerr << "[ERROR] CpuReference: tied source must be an earlier dense layer of matching shape\n";
+                return false;
+            }
+        }
+        m_weightStart.push_back(m_totalWeights);
+        m_totalWeights += static_cast<uint32_t>(layerWeightCount(m_shapes.back(), desc));
+        m_totalBiases += static_cast<uint32_t>(layerBiasCount(desc));
+        m_activationTypes.push_back(desc.activation);
+        m_shapes.push_back(out);
+    }
+
+    m_topology.clear();
+    for (const TensorShape& shape : m_shapes) {
+        m_topology.push_back(static_cast<uint32_t>(shape.size()));
+    }
+    m_totalNeurons = std::accumulate(m_topology.begin(), m_topology.end(), 0u);
+
+    m_weights.assign(m_totalWeights, 0.0f);
+    m_biases.assign(m_totalBiases, 0.0f);
+    m_activations.assign(m_totalNeurons, 0.0f);
+    packBinaryWeights();
+    return true;
+}
+
+bool CpuReference::setWeights(const std::vector<float>& weights) {
+    if (weights.size() != m_totalWeights) {
+        std::cerr << "[ERROR] CpuReference: weight count mismatch. Expected "
+                  << m_totalWeights << ", got " << weights.size() << "\n";
+        return false;
+    }
+    m_weights = weights;
+    packBinaryWeights();
+    return true;
+}
+
+bool CpuReference::setBiases(const std::vector<float>& biases) {
+    if (biases.size() != m_totalBiases) {
+        std::cerr << "[ERROR] CpuReference: bias count mismatch. Expected "
+                  << m_totalBiases << ", got " << biases.size() << "\n";
+        return false;
+    }
+    m_biases = biases;
+    return true;
+}
+
+void CpuReference::forward(const std::vector<float>& inputs, std::vector<float>& outputs) {
+    if (m_topology.empty() || inputs.size() != m_topology[0]) {
+        std::cerr << "[ERROR] CpuReference: input size mismatch\n";
+        return;
+    }
+
+    std::copy(inputs.begin(), inputs.end(), m_activations.begin());
+
+    uint32_t inputOffset = 0;
+    uint32_t weightOffset = 0;
+    uint32_t biasOffset = 0;
+
+    for (size_t layer = 0; layer < m_topology.size() - 1; ++layer) {
+        const uint32_t inputSize = m_topology[layer];
+        const uint32_t outputSize = m_topology[layer + 1];
+        const uint32_t outputOffset = inputOffset + inputSize;
+
+        const float* in = m_activations.data() + inputOffset;
+        const float* skip = residualInput(layer);
+        float* out = m_activations.data() + outputOffset;
+
+        if (m_layers[layer].isPooling()) {
+            pool(layer, in, skip, out);
+            inputOffset = outputOffset;
+            continue;
+        }
+
+        if (m_layers[layer].kind == LayerKind::BinaryDense) {
+            binaryDense(layer, in, m_biases.data() + biasOffset, skip, out);
+            inputOffset = outputOffset;
+            weightOffset += inputSize * outputSize;
+            biasOffset += outputSize;
+            continue;
+        }
+
+        if (m_layers[layer].kind == LayerKind::LowRankDense) {
+            lowRankDense(layer, in, m_weights.data() + weightOffset, m_biases.data() + biasOffset, skip, out);
+            inputOffset = outputOffset;
+            weightOffset += static_cast<uint32_t>(layerWeightCount(m_shapes[layer], m_layers[layer]));
+            biasOffset += outputSize;
+            continue;
+        }
+
+        if (m_layers[layer].kind == LayerKind::Conv2D) {
+            convolve(layer, in, m_weights.data() + weightOffset, m_biases.data() + biasOffset, skip, out);
+            inputOffset = outputOffset;
+            weightOffset += static_cast<uint32_t>(layerWeightCount(m_shapes[layer], m_layers[layer]));
+            biasOffset += m_layers[layer].outChannels;
+            continue;
+        }
+
+        // Tied layers read their source's matrix, transposed: element (o, i) is source (i, o)
+        const LayerDesc& desc = m_layers[layer];
+        const float* weights = m_weights.data() + (desc.tiedTo >= 0 ? m_weightStart[desc.tiedTo] : weightOffset);
+        const bool transposed = desc.tiedTo >= 0 && desc.tiedTransposed;
+        for (uint32_t o = 0; o < outputSize; ++o) {
+            const float* row = weights + o * inputSize;
+
+            float sum = 0.0f;
+            if (transposed) {
+                for (uint32_t i = 0; i < inputSize; ++i) {
+                    sum += in[i] * weights[i * outputSize + o];
+                }
+            } else {
+                for (uint32_t i = 0; i < inputSize; ++i) {
+                    sum += in[i] * row[i];
+                }
+            }
+            sum += m_biases[biasOffset + o];
+            if (skip) {
+                sum += skip[o];
+            }
+
+            out[o] = applyActivation(sum, m_activationTypes[layer]);
+        }
+
+        if (m_activationTypes[layer] == kSoftmax) {
+            applySoftmax(out, outputSize);
+        }
+
+        inputOffset = outputOffset;
+        weightOffset += static_cast<uint32_t>(layerWeightCount(m_shapes[layer], desc));
+        biasOffset += outputSize;
+    }
+
+    const uint32_t outputSize = m_topology.back();
+    outputs.assign(m_activations.end() - outputSize, m_activations.end());
+}
+
+void CpuReference::packBinaryWeights() {
+    m_binaryLayers.assign(m_layers.size(), {});
+
+    size_t weightOffset = 0;
+    for (size_t layer = 0; layer < m_layers.size(); ++layer) {
+        const size_t count = layerWeightCount(m_shapes[layer], m_layers[layer]);
+        if (m_layers[layer].kind == LayerKind::BinaryDense) {
+            const uint32_t inputSize = static_cast<uint32_t>(m_shapes[layer].size());
+            const uint32_t outputSize = static_cast<uint32_t>(m_shapes[layer + 1].size());
+            BinaryLayer& binary = m_binaryLayers[layer];
+            binary.words = (inputSize + 63) / 64;
+            binary.bits.assign(static_cast<size_t>(outputSize) * binary.words, 0);
+            binary.alpha.assign(outputSize, 0.0f);
+
+            for (uint32_t o = 0; o < outputSize; ++o) {
+                const float* row = m_weights.data() + weightOffset + static_cast<size_t>(o) * inputSize;
+                uint64_t* bits = binary.bits.data() + static_cast<size_t>(o) * binary.words;
+                float absSum = 0.0f;
+                for (uint32_t i = 0; i < inputSize; ++i) {
+                    absSum += std::fabs(row[i]);
+                    if (row[i] > 0.0f) {
+                        bits[i / 64] |= uint64_t{1} << (i % 64);
+                    }
+                }
+                binary.alpha[o] = absSum / static_cast<float>(inputSize);
+            }
+        }
+        weightOffset += count;
+    }
+}
+
+void CpuReference::binaryDense(size_t layer, const float* in, const float* biases,
+                               const float* skip, float* out) {
+    const BinaryLayer& binary = m_binaryLayers[layer];
+    const uint32_t inputSize = m_topology[layer];
+    const uint32_t outputSize = m_topology[layer + 1];
+
+    // Input signs, padding bits 0 (same as the weight rows)
+    m_inputBits.assign(binary.words, 0);
+    for (uint32_t i = 0; i < inputSize; ++i) {
+        if (in[i] > 0.0f) {
+            m_inputBits[i / 64] |= uint64_t{1} << (i % 64);
+        }
+    }
+    const int padding = static_cast<int>(binary.words * 64 - inputSize);
+
+    for (uint32_t o = 0; o < outputSize; ++o) {
+        const uint64_t* row = binary.bits.data() + static_cast<size_t>(o) * binary.words;
+        int matches = 0;
+        for (uint32_t w = 0; w < binary.words; ++w) {
+            matches += std::popcount(~(m_inputBits[w] ^ row[w]));
+        }
+        matches -= padding;     // Padding bits agree on both sides
+
+        float sum = binary.alpha[o] * static_cast<float>(2 * matches - static_cast<int>(inputSize)) + biases[o];
+        if (skip) {
+            sum += skip[o];
+        }
+        out[o] = applyActivation(sum, m_activationTypes[layer]);
+    }
+}
+
+void CpuReference::lowRankDense(size_t layer, const float* in, const float* weights,
+                                const float* biases, const float* skip, float* out) {
+    const uint32_t inputSize = m_topology[layer];
+    const uint32_t outputSize = m_topology[layer + 1];
+    const uint32_t rank = m_layers[layer].rank;
+    const float* u = weights;                                               // [out][r]
+    const float* v = weights + static_cast<size_t>(outputSize) * rank;     // [r][in]
+
+    // h = V * x, then y = U * h
+    m_hidden.assign(rank, 0.0f);
+    for (uint32_t k = 0; k < rank; ++k) {
+        const float* row = v + static_cast<size_t>(k) * inputSize;
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < inputSize; ++i) {
+            sum += row[i] * in[i];
+        }
+        m_hidden[k] = sum;
+    }
+
+    for (uint32_t o = 0; o < outputSize; ++o) {
+        const float* row = u + static_cast<size_t>(o) * rank;
+        float sum = biases[o];
+        for (uint32_t k = 0; k < rank; ++k) {
+            sum += row[k] * m_hidden[k];
+        }
+        if (skip) {
+            sum += skip[o];
+        }
+        out[o] = applyActivation(sum, m_activationTypes[layer]);
+    }
+}
+
+void CpuReference::convolve(size_t layer, const float* in, const float* weights,
+                           const float* biases, const float* skip, float* out) const {
+    const LayerDesc& desc = m_layers[layer];
+    const TensorShape& inShape = m_shapes[layer];
+    const TensorShape& outShape = m_shapes[layer + 1];
+    const int k = static_cast<int>(desc.kernelSize);
+
+    for (uint32_t oc = 0; oc < outShape.channels; ++oc) {
+        for (uint32_t oy = 0; oy < outShape.height; ++oy) {
+            for (uint32_t ox = 0; ox < outShape.width; ++ox) {
+                // Top-left input tap; taps outside the input read the zero padding
+                const int iy0 = static_cast<int>(oy * desc.stride) - static_cast<int>(desc.padding);
+                const int ix0 = static_cast<int>(ox * desc.stride) - static_cast<int>(desc.padding);
+
+                float sum = 0.0f;
+                for (uint32_t ic = 0; ic < inShape.channels; ++ic) {
+                    const float* plane = in + static_cast<size_t>(ic) * inShape.height * inShape.width;
+                    const float* kernel = weights + (static_cast<size_t>(oc) * inShape.channels + ic) * k * k;
+                    for (int ky = 0; ky < k; ++ky) {
+                        const int iy = iy0 + ky;
+                        if (iy < 0 || iy >= static_cast<int>(inShape.height)) continue;
+                        for (int kx = 0; kx < k; ++kx) {
+                            const int ix = ix0 + kx;
+                            if (ix < 0 || ix >= static_cast<int>(inShape.width)) continue;
+                            sum += plane[iy * inShape.width + ix] * kernel[ky * k + kx];
+                        }
+                    }
+                }
+                sum += biases[oc];
+
+                const size_t index = (static_cast<size_t>(oc) * outShape.height + oy) * outShape.width + ox;
+                if (skip) {
+                    sum += skip[index];
+                }
+                out[index] = applyActivation(sum, desc.activation);
+            }
+        }
+    }
+}
+
+void CpuReference::pool(size_t layer, const float* in, const float* skip, float* out) const {
+    const LayerDesc& desc = m_layers[layer];
+    const TensorShape& inShape = m_shapes[layer];
+    const TensorShape& outShape = m_shapes[layer + 1];
+    const int k = static_cast<int>(desc.kernelSize);
+
+    for (uint32_t c = 0; c < outShape.channels; ++c) {
+        const float* plane = in + static_cast<size_t>(c) * inShape.height * inShape.width;
+        for (uint32_t oy = 0; oy < outShape.height; ++oy) {
+            for (uint32_t ox = 0; ox < outShape.width; ++ox) {
+                const int iy0 = static_cast<int>(oy * desc.stride) - static_cast<int>(desc.padding);
+                const int ix0 = static_cast<int>(ox * desc.stride) - static_cast<int>(desc.padding);
+
+                // Padding taps are skipped, as in pool2d.comp
+                float maxValue = -std::numeric_limits<float>::max();
+                float sum = 0.0f;
+                uint32_t taps = 0;
+                for (int ky = 0; ky < k; ++ky) {
+                    const int iy = iy0 + ky;
+                    if (iy < 0 || iy >= static_cast<int>(inShape.height)) continue;
+                    for (int kx = 0; kx < k; ++kx) {
+                        const int ix = ix0 + kx;
+                        if (ix < 0 || ix >= static_cast<int>(inShape.width)) continue;
+                        const float value = plane[iy * inShape.width + ix];
+                        maxValue = std::max(maxValue, value);
+                        sum += value;
+                        taps++;
+                    }
+                }
+
+                float pooled = desc.kind == LayerKind::MaxPool2D
+                                   ? maxValue : sum / static_cast<float>(std::max(taps, 1u));
+                const size_t index = (static_cast<size_t>(c) * outShape.height + oy) * outShape.width + ox;
+                if (skip) {
+                    pooled += skip[index];
+                }
+                out[index] = applyActivation(pooled, desc.activation);
+            }
+        }
+    }
+}
+
+const float* CpuReference::residualInput(size_t layer) const {
+    const int32_t source = m_layers[layer].residualFrom;
+    if (source < 0) {
+        return nullptr;
+    }
+    const uint32_t offset = std::accumulate(m_topology.begin(), m_topology.begin() + source, 0u);
+    return m_activations.data() + offset;
+}
+
+void CpuReference::applySoftmax(float* values, uint32_t count) {
+    // Subtract the max before exp() for numerical stability (same as forward.comp)
+    float maxValue = *std::max_element(values, values + count);
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < count; ++i) {
+        values[i] = std::exp(values[i] - maxValue);
+        sum += values[i];
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        values[i] /= sum;
+    }
+}
+
+float CpuReference::applyActivation(float x, uint32_t activationType) {
+    switch (activationType) {
+        case 0: return x > 0.0f ? x : 0.0f;
+        case 1: return 1.0f / (1.0f + std::exp(-x));
+        case 2: return std::tanh(x);
+        default: return x;  // Linear fallback (softmax is applied per layer by applySoftmax)
+    }
+}
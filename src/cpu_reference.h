@@ -0,0 +1,110 @@
+#pragma once
+
+#include "layer_desc.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CPU reference implementation of the forward pass
+ *
+ * Mirrors the GPU data layout exactly:
+ * - Weights: flat array, per layer [outputNeuron][inputNeuron] (conv: [outC][inC][ky][kx],
+ *   pooling: none; binary dense: float weights, binarized by setWeights; low-rank dense:
+ *   U [out][r] then V [r][in]; tied dense: none, reads its source layer's)
+ * - Biases: flat array, per layer [outputNeuron] (conv: [outC])
+ * - Activation types: 0=ReLU, 1=Sigmoid, 2=Tanh, other=Linear
+ *
+ * Used to validate GPU results and as the baseline backend for benchmarks.
+ */
+class CpuReference {
+public:
+    CpuReference() = default;
+
+    /**
+     * @brief Initialize for a network topology (same arguments as NeuralBuffers)
+     * @param layerSizes Size of each layer (e.g., {2, 2, 1} for XOR)
+     * @param activations Activation type per layer (same length as layerSizes - 1)
+     * @return true if topology is valid
+     */
+    bool initialize(const std::vector<uint32_t>& layerSizes,
+                    const std::vector<uint32_t>& activations);
+
+    /**
+     * @brief Initialize for dense and convolution layers (same arguments as NeuralBuffers)
+     * @param inputShape Shape of the input feature map
+     * @param layers One descriptor per computed layer
+     * @return true if every layer fits its input
+     */
+    bool initialize(const TensorShape& inputShape, const std::vector<LayerDesc>& layers);
+
+    /**
+     * @brief Set weight data (same flat layout as NeuralBuffers::uploadWeights)
+     */
+    bool setWeights(const std::vector<float>& weights);
+
+    /**
+     * @brief Set bias data (same flat layout as NeuralBuffers::uploadBiases)
+     */
+    bool setBiases(const std::vector<float>& biases);
+
+    /**
+     * @brief Run a full forward pass on the CPU
+     * @param inputs Input values to network
+     * @param outputs Vector to store output values (last layer)
+     */
+    void forward(const std::vector<float>& inputs, std::vector<float>& outputs);
+
+    /**
+     * @brief Get all activations from the last forward pass (same layout as the activations SSBO)
+     */
+    const std::vector<float>& getAllActivations() const { return m_activations; }
+
+    uint32_t getTotalWeightCount() const { return m_totalWeights; }
+    uint32_t getTotalBiasCount() const { return m_totalBiases; }
+
+    static float applyActivation(float x, uint32_t activationType);
+
+    /**
+     * @brief In-place numerically stable softmax (activation type 4)
+     */
+    static void applySoftmax(float* values, uint32_t count);
+
+private:
+    static constexpr uint32_t kSoftmax = 4;   // NeuralBuffers::Activation::Softmax
+
+    std::vector<uint32_t> m_topology;
+    std::vector<uint32_t> m_activationTypes;
+    std::vector<TensorShape> m_shapes;     // Per topology layer
+    std::vector<LayerDesc> m_layers;       // Per computed layer
+
+    std::vector<uint32_t> m_weightStart;   // Per computed layer, offset into m_weights
+    std::vector<float> m_weights;
+    std::vector<float> m_biases;
+    std::vector<float> m_activations;      // All layers, concatenated
+
+    /** @brief Sign bits of one binary dense layer (same binarization as NeuralBuffers) */
+    struct BinaryLayer {
+        uint32_t words = 0;                 // 64-bit words per row
+        std::vector<uint64_t> bits;         // [outputNeuron][word], bit set = +1
+        std::vector<float> alpha;           // [outputNeuron] mean |w| of the row
+    };
+    std::vector<BinaryLayer> m_binaryLayers;   // Per computed layer, empty unless BinaryDense
+    std::vector<uint64_t> m_inputBits;         // Scratch: packed input of the current layer
+    std::vector<float> m_hidden;               // Scratch: low-rank bottleneck V * x
+
+    uint32_t m_totalWeights = 0;
+    uint32_t m_totalBiases = 0;
+    uint32_t m_totalNeurons = 0;
+
+    void convolve(size_t layer, const float* in, const float* weights, const float* biases,
+                  const float* skip, float* out) const;
+    void pool(size_t layer, const float* in, const float* skip, float* out) const;
+    void binaryDense(size_t layer, const float* in, const float* biases, const float* skip, float* out);
+    void lowRankDense(size_t layer, const float* in, const float* weights, const float* biases,
+                      const float* skip, float* out);
+    void packBinaryWeights();
+
+    /** @brief Activations added before the layer's activation, nullptr if it has no residual */
+    const float* residualInput(size_t layer) const;
+};
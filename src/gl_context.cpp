@@ -27,6 +27,8 @@ bool GLContext::initialize(const Config& config) {
         glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
     }
 
+    glfwWindowHint(GLFW_VISIBLE, m_config.visible ? GLFW_TRUE : GLFW_FALSE);
+
     // Create window
     m_window = glfwCreateWindow(m_config.width, m_config.height,
                                  m_config.title.c_str(), nullptr, nullptr);
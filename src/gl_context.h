@@ -24,6 +24,7 @@ public:
         std::string title = "GPU Neural Network Visualizer";
         bool enableVSync = true;
         bool enableDebugOutput = true;
+        bool visible = true;            // Hidden windows are used for headless benchmarks
         int glMajorVersion = 4;
         int glMinorVersion = 6;
     };
@@ -0,0 +1,91 @@
+#include "inference_cache.h"
+#include <cstring>
+
+bool InferenceCache::lookup(const std::vector<float>& inputs, uint64_t weightsVersion,
+                            std::vector<float>& outputs) {
+    auto it = m_index.find(hashKey(inputs, weightsVersion));
+    if (it == m_index.end() || it->second->weightsVersion != weightsVersion ||
+        it->second->inputs.size() != inputs.size() ||
+        std::memcmp(it->second->inputs.data(), inputs.data(), inputs.size() * sizeof(float)) != 0) {
+        m_stats.misses++;
+        return false;
+    }
+
+    // Move to the front: most recently used
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    outputs = it->second->outputs;
+    m_stats.hits++;
+    return true;
+}
+
+void InferenceCache::insert(const std::vector<float>& inputs, uint64_t weightsVersion,
+                            const std::vector<float>& outputs) {
+    Entry entry;
+    entry.key = hashKey(inputs, weightsVersion);
+    entry.weightsVersion = weightsVersion;
+    entry.inputs = inputs;
+    entry.outputs = outputs;
+
+    const size_t bytes = entryBytes(entry);
+    if (bytes > m_config.maxBytes) {
+        return;     // Would evict everything and still not fit
+    }
+
+    // Same key (re-insert or hash collision): the new entry replaces the old one
+    auto it = m_index.find(entry.key);
+    if (it != m_index.end()) {
+        m_stats.bytes -= entryBytes(*it->second);
+        m_lru.erase(it->second);
+        m_index.erase(it);
+    }
+
+    evictTo(m_config.maxBytes - bytes);
+
+    m_lru.push_front(std::move(entry));
+    m_index[m_lru.front().key] = m_lru.begin();
+    m_stats.bytes += bytes;
+    m_stats.entries = m_lru.size();
+}
+
+void InferenceCache::clear() {
+    m_lru.clear();
+    m_index.clear();
+    m_stats.entries = 0;
+    m_stats.bytes = 0;
+}
+
+void InferenceCache::setConfig(const Config& config) {
+    m_config = config;
+    evictTo(m_config.maxBytes);
+}
+
+uint64_t InferenceCache::hashKey(const std::vector<float>& inputs, uint64_t weightsVersion) {
+    // FNV-1a over the input bytes, then the weights version
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(inputs.data(), inputs.size() * sizeof(float));
+    mix(&weightsVersion, sizeof(weightsVersion));
+    return hash;
+}
+
+size_t InferenceCache::entryBytes(const Entry& entry) {
+    // Payload plus the list node and index slot, roughly
+    return (entry.inputs.size() + entry.outputs.size()) * sizeof(float) + sizeof(Entry) + 64;
+}
+
+void InferenceCache::evictTo(size_t maxBytes) {
+    while (!m_lru.empty() && m_stats.bytes > maxBytes) {
+        const Entry& victim = m_lru.back();
+        m_stats.bytes -= entryBytes(victim);
+        m_index.erase(victim.key);
+        m_lru.pop_back();
+        m_stats.evictions++;
+    }
+    m_stats.entries = m_lru.size();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief LRU cache of forward pass results, keyed by input content
+ *
+ * An entry is found by a 64-bit hash of the input bytes and the weights version
+ * (NeuralBuffers::getWeightsVersion(), bumped by every parameter change), then
+ * verified against the stored input so a hash collision is a miss, never a wrong
+ * result. Used by NeuralCompute::infer(): a hit skips upload, dispatch and readback.
+ *
+ * Memory is capped by Config::maxBytes (inputs + outputs + per-entry overhead);
+ * inserting past the cap evicts least recently used entries.
+ */
+class InferenceCache {
+public:
+    struct Config {
+        size_t maxBytes = 16 * 1024 * 1024;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    InferenceCache() = default;
+    explicit InferenceCache(const Config& config) : m_config(config) {}
+
+    /**
+     * @brief Look up the outputs for an input under a weights version
+     * @return true on a hit (outputs filled, entry becomes most recently used)
+     */
+    bool lookup(const std::vector<float>& inputs, uint64_t weightsVersion, std::vector<float>& outputs);
+
+    /**
+     * @brief Store the outputs computed for an input, evicting LRU entries past the cap
+     */
+    void insert(const std::vector<float>& inputs, uint64_t weightsVersion, const std::vector<float>& outputs);
+
+    /**
+     * @brief Drop every entry (counters are kept)
+     */
+    void clear();
+
+    void setConfig(const Config& config);
+    const Config& getConfig() const { return m_config; }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    struct Entry {
+        uint64_t key = 0;
+        uint64_t weightsVersion = 0;
+        std::vector<float> inputs;
+        std::vector<float> outputs;
+    };
+
+    Config m_config;
+    Stats m_stats;
+    std::list<Entry> m_lru;     // Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+
+    static uint64_t hashKey(const std::vector<float>& inputs, uint64_t weightsVersion);
+    static size_t entryBytes(const Entry& entry);
+    void evictTo(size_t maxBytes);
+};
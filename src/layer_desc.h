@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Feature map shape (channels x height x width)
+ *
+ * Dense layers are C x 1 x 1. Activations are stored flat in [c][y][x] order,
+ * so a layer's neuron count is channels * height * width either way.
+ */
+struct TensorShape {
+    uint32_t channels = 1;
+    uint32_t height = 1;
+    uint32_t width = 1;
+
+    uint64_t size() const { return static_cast<uint64_t>(channels) * height * width; }
+    bool isSpatial() const { return height > 1 || width > 1; }
+};
+
+/**
+ * @brief Kind of computation a layer performs (LayerInfo::layerKind)
+ */
+enum class LayerKind : uint32_t {
+    Dense = 0,      // Fully connected, weights [out][in]
+    Conv2D = 1,     // Direct convolution, weights [outC][inC][ky][kx], biases [outC]
+    MaxPool2D = 2,  // Per-channel window max, no parameters
+    AvgPool2D = 3,  // Per-channel window mean over in-bounds taps, no parameters
+    BinaryDense = 4,    // Fully connected on signs: inputs and weights binarized to +-1 (XNOR-popcount)
+    LowRankDense = 5    // Fully connected through a rank-r bottleneck, weights U [out][r] then V [r][in]
+};
+
+/**
+ * @brief Description of one layer, used to build NeuralBuffers and CpuReference
+ *
+ * The input shape of each layer is the output shape of the previous one; a dense
+ * layer after a conv layer sees the flattened [c][y][x] feature map.
+ */
+struct LayerDesc {
+    LayerKind kind = LayerKind::Dense;
+    uint32_t activation = 0;        // NeuralBuffers::Activation
+
+    uint32_t units = 0;             // Dense/BinaryDense/LowRankDense: output neurons
+    uint32_t rank = 0;              // LowRankDense only: inner dimension r of W = U * V
+
+    uint32_t outChannels = 0;       // Conv2D only
+    uint32_t kernelSize = 3;        // Conv2D/pooling: square window, same stride/padding on both axes
+    uint32_t stride = 1;
+    uint32_t padding = 0;
+
+    // Residual add: topology layer (0 = network input, i = output of layer i - 1) whose
+    // activations are added to this layer's pre-activation output, -1 for none.
+    // Must be at or before this layer's input and have the same size as its output.
+    int32_t residualFrom = -1;
+
+    // Tied weights: earlier computed layer whose weight matrix this dense layer reads
+    // instead of owning one, -1 for none. A transposed tie reads W^T (e.g. the decoder of a
+    // tied autoencoder). Tied layers own no entries in the flat weights array; biases stay private.
+    int32_t tiedTo = -1;
+    bool tiedTransposed = false;
+
+    static LayerDesc dense(uint32_t units, uint32_t activation) {
+        LayerDesc desc;
+        desc.units = units;
+        desc.activation = activation;
+        return desc;
+    }
+
+    /**
+     * @brief Binarized dense layer: y = act(alpha * sum(sign(w) * sign(x)) + b)
+     *
+     * Weights are given as floats like a dense layer; each row is stored as sign bits plus
+     * alpha = mean |w|. Inputs are binarized as x > 0 -> +1, otherwise -1.
+     */
+    static LayerDesc binaryDense(uint32_t units, uint32_t activation) {
+        LayerDesc desc = dense(units, activation);
+        desc.kind = LayerKind::BinaryDense;
+        return desc;
+    }
+
+    /**
+     * @brief Factorized dense layer: y = act(U * (V * x) + b), U is out x r, V is r x in
+     *
+     * Costs r * (in + out) weights and MACs instead of in * out; tools/low_rank.cpp
+     * produces the factors from a trained dense layer by truncated SVD.
+     */
+    static LayerDesc lowRankDense(uint32_t units, uint32_t rank, uint32_t activation) {
+        LayerDesc desc = dense(units, activation);
+        desc.kind = LayerKind::LowRankDense;
+        desc.rank = rank;
+        return desc;
+    }
+
+    /**
+     * @brief Dense layer sharing the weights of an earlier dense layer
+     *
+     * Untransposed, the source must have the same input and output sizes; transposed, the
+     * source maps units -> this layer's input size. The shared matrix is stored once, so
+     * edits to it (setWeight on the source) reach both layers.
+     */
+    static LayerDesc tiedDense(uint32_t units, uint32_t sourceLayer, bool transposed, uint32_t activation) {
+        LayerDesc desc = dense(units, activation);
+        desc.tiedTo = static_cast<int32_t>(sourceLayer);
+        desc.tiedTransposed = transposed;
+        return desc;
+    }
+
+    static LayerDesc conv2d(uint32_t outChannels, uint32_t kernelSize, uint32_t stride,
+                            uint32_t padding, uint32_t activation) {
+        LayerDesc desc;
+        desc.kind = LayerKind::Conv2D;
+        desc.outChannels = outChannels;
+        desc.kernelSize = kernelSize;
+        desc.stride = stride;
+        desc.padding = padding;
+        desc.activation = activation;
+        return desc;
+    }
+
+    static LayerDesc maxPool2d(uint32_t kernelSize, uint32_t stride, uint32_t padding = 0) {
+        LayerDesc desc;
+        desc.kind = LayerKind::MaxPool2D;
+        desc.kernelSize = kernelSize;
+        desc.stride = stride;
+        desc.padding = padding;
+        desc.activation = 3;    // Linear
+        return desc;
+    }
+
+    static LayerDesc avgPool2d(uint32_t kernelSize, uint32_t stride, uint32_t padding = 0) {
+        LayerDesc desc = maxPool2d(kernelSize, stride, padding);
+        desc.kind = LayerKind::AvgPool2D;
+        return desc;
+    }
+
+    bool isPooling() const { return kind == LayerKind::MaxPool2D || kind == LayerKind::AvgPool2D; }
+    bool isDense() const {
+        return kind == LayerKind::Dense || kind == LayerKind::BinaryDense || kind == LayerKind::LowRankDense;
+    }
+    bool hasWeights() const { return isDense() || kind == LayerKind::Conv2D; }
+};
+
+/**
+ * @brief Output shape of a layer for a given input shape
+ *
+ * Returns an empty shape (size() == 0) if the kernel does not fit the padded input.
+ */
+inline TensorShape layerOutputShape(const TensorShape& in, const LayerDesc& desc) {
+    TensorShape out;
+    switch (desc.kind) {
+        case LayerKind::Conv2D:
+        case LayerKind::MaxPool2D:
+        case LayerKind::AvgPool2D: {
+            const uint32_t paddedH = in.height + 2 * desc.padding;
+            const uint32_t paddedW = in.width + 2 * desc.padding;
+            if (desc.stride == 0 || desc.kernelSize == 0 ||
+                paddedH < desc.kernelSize || paddedW < desc.kernelSize) {
+                out.channels = 0;
+                return out;
+            }
+            out.channels = desc.kind == LayerKind::Conv2D ? desc.outChannels : in.channels;
+            out.height = (paddedH - desc.kernelSize) / desc.stride + 1;
+            out.width = (paddedW - desc.kernelSize) / desc.stride + 1;
+            return out;
+        }
+        case LayerKind::Dense:
+        case LayerKind::BinaryDense:
+        case LayerKind::LowRankDense:
+        default:
+            out.channels = desc.units;
+            return out;
+    }
+}
+
+/**
+ * @brief Number of weights a layer owns in the flat weights array
+ */
+inline uint64_t layerWeightCount(const TensorShape& in, const LayerDesc& desc) {
+    if (desc.tiedTo >= 0) {
+        return 0;   // Stored once, with the source layer
+    }
+    switch (desc.kind) {
+        case LayerKind::Conv2D:
+            return static_cast<uint64_t>(desc.outChannels) * in.channels * desc.kernelSize * desc.kernelSize;
+        case LayerKind::MaxPool2D:
+        case LayerKind::AvgPool2D:
+            return 0;
+        case LayerKind::LowRankDense:
+            return static_cast<uint64_t>(desc.rank) * (desc.units + in.size());
+        case LayerKind::Dense:
+        case LayerKind::BinaryDense:
+        default:
+            return in.size() * desc.units;
+    }
+}
+
+/**
+ * @brief Number of biases a layer owns in the flat biases array
+ */
+inline uint64_t layerBiasCount(const LayerDesc& desc) {
+    switch (desc.kind) {
+        case LayerKind::Conv2D:       return desc.outChannels;
+        case LayerKind::Dense:
+        case LayerKind::BinaryDense:
+        case LayerKind::LowRankDense: return desc.units;
+        default:                      return 0;
+    }
+}
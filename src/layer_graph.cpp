@@ -0,0 +1,259 @@
+#include "layer_graph.h"
+#include <iostream>
+#include <utility>
+
+namespace {
+
+// NeuralBuffers::Activation values (kept here so the IR has no GL dependency)
+constexpr uint32_t kActivationLinear = 3;
+constexpr uint32_t kActivationSoftmax = 4;
+
+const char* opName(LayerGraph::Op op) {
+    switch (op) {
+        case LayerGraph::Op::Input:      return "Input";
+        case LayerGraph::Op::Dense:      return "Dense";
+        case LayerGraph::Op::Conv2D:     return "Conv2D";
+        case LayerGraph::Op::MaxPool2D:  return "MaxPool2D";
+        case LayerGraph::Op::AvgPool2D:  return "AvgPool2D";
+        case LayerGraph::Op::Add:        return "Add";
+        case LayerGraph::Op::Activation: return "Activation";
+        case LayerGraph::Op::Softmax:    return "Softmax";
+    }
+    return "Unknown";
+}
+
+bool isProducer(LayerGraph::Op op) {
+    return op == LayerGraph::Op::Dense || op == LayerGraph::Op::Conv2D ||
+           op == LayerGraph::Op::MaxPool2D || op == LayerGraph::Op::AvgPool2D;
+}
+
+} // namespace
+
+int LayerGraph::addNode(Op op, std::vector<int> inputs, const LayerDesc& desc) {
+    for (int input : inputs) {
+        if (input < 0 || input >= static_cast<int>(m_nodes.size())) {
+            std::cerr << "[ERROR] LayerGraph: " << opName(op) << " input " << input << " does not exist\n";
+            return -1;
+        }
+    }
+
+    Node node;
+    node.op = op;
+    node.inputs = std::move(inputs);
+    node.desc = desc;
+    m_nodes.push_back(node);
+    return static_cast<int>(m_nodes.size() - 1);
+}
+
+int LayerGraph::addInput(const TensorShape& shape) {
+    if (!m_nodes.empty()) {
+        std::cerr << "[ERROR] LayerGraph: the input must be the first and only Input node\n";
+        return -1;
+    }
+    int node = addNode(Op::Input, {}, LayerDesc{});
+    m_nodes[node].shape = shape;
+    return node;
+}
+
+int LayerGraph::addDense(int input, uint32_t units) {
+    return addNode(Op::Dense, {input}, LayerDesc::dense(units, kActivationLinear));
+}
+
+int LayerGraph::addConv2D(int input, uint32_t outChannels, uint32_t kernelSize,
+                          uint32_t stride, uint32_t padding) {
+    return addNode(Op::Conv2D, {input},
+                   LayerDesc::conv2d(outChannels, kernelSize, stride, padding, kActivationLinear));
+}
+
+int LayerGraph::addMaxPool2D(int input, uint32_t kernelSize, uint32_t stride, uint32_t padding) {
+    return addNode(Op::MaxPool2D, {input}, LayerDesc::maxPool2d(kernelSize, stride, padding));
+}
+
+int LayerGraph::addAvgPool2D(int input, uint32_t kernelSize, uint32_t stride, uint32_t padding) {
+    return addNode(Op::AvgPool2D, {input}, LayerDesc::avgPool2d(kernelSize, stride, padding));
+}
+
+int LayerGraph::addAdd(int a, int b) {
+    return addNode(Op::Add, {a, b}, LayerDesc{});
+}
+
+int LayerGraph::addActivation(int input, uint32_t activation) {
+    LayerDesc desc;
+    desc.activation = activation;
+    return addNode(Op::Activation, {input}, desc);
+}
+
+int LayerGraph::addSoftmax(int input) {
+    return addNode(Op::Softmax, {input}, LayerDesc{});
+}
+
+bool LayerGraph::inferShapes() {
+    if (m_nodes.empty() || m_nodes[0].op != Op::Input) {
+        std::cerr << "[ERROR] LayerGraph: graph has no input\n";
+        return false;
+    }
+
+    for (size_t n = 1; n < m_nodes.size(); ++n) {
+        Node& node = m_nodes[n];
+        const TensorShape& in = m_nodes[node.inputs[0]].shape;
+
+        if (isProducer(node.op)) {
+            node.shape = layerOutputShape(in, node.desc);
+            if (node.shape.size() == 0) {
+                std::cerr << "[ERROR] LayerGraph: " << opName(node.op) << " node " << n
+                          << " produces an empty output\n";
+                return false;
+            }
+        } else if (node.op == Op::Add) {
+            const TensorShape& other = m_nodes[node.inputs[1]].shape;
+            if (in.channels != other.channels || in.height != other.height || in.width != other.width) {
+                std::cerr << "[ERROR] LayerGraph: Add node " << n << " operands differ in shape\n";
+                return false;
+            }
+            node.shape = in;
+        } else {
+            node.shape = in;    // Elementwise
+        }
+    }
+    return true;
+}
+
+bool LayerGraph::compile() {
+    m_groups.clear();
+    m_layers.clear();
+
+    if (!inferShapes()) {
+        return false;
+    }
+
+    std::vector<int> consumers(m_nodes.size(), 0);
+    for (const Node& node : m_nodes) {
+        for (int input : node.inputs) {
+            consumers[input]++;
+        }
+    }
+
+    std::vector<FusedGroup> groups;
+    std::vector<LayerDesc> layers;
+
+    for (size_t i = 1; i < m_nodes.size(); ++i) {
+        const int n = static_cast<int>(i);
+        const Node& node = m_nodes[n];
+
+        if (isProducer(node.op)) {
+            FusedGroup group;
+            group.nodes = {n};
+            group.output = n;
+            group.input = node.inputs[0];
+            groups.push_back(group);
+            layers.push_back(node.desc);
+            continue;
+        }
+
+        // Elementwise: try to merge into the group that produced the operand
+        FusedGroup* group = groups.empty() ? nullptr : &groups.back();
+        LayerDesc* desc = layers.empty() ? nullptr : &layers.back();
+
+        int operand = node.inputs[0];
+        int other = node.op == Op::Add ? node.inputs[1] : -1;
+        if (node.op == Op::Add && group && other == group->output) {
+            std::swap(operand, other);
+        }
+
+        // The producer's own value must not be needed elsewhere, and the kernel applies
+        // at most one skip add followed by one activation
+        bool canFuse = group && operand == group->output && consumers[operand] == 1 &&
+                       desc->activation == kActivationLinear;
+        if (node.op == Op::Softmax) {
+            canFuse = canFuse && desc->kind == LayerKind::Dense;
+        } else if (node.op == Op::Add) {
+            canFuse = canFuse && group->skip < 0;
+        }
+
+        if (canFuse) {
+            group->nodes.push_back(n);
+            group->output = n;
+            if (node.op == Op::Activation) {
+                desc->activation = node.desc.activation;
+            } else if (node.op == Op::Softmax) {
+                desc->activation = kActivationSoftmax;
+            } else {
+                group->skip = other;
+            }
+            continue;
+        }
+
+        if (node.op == Op::Activation || node.op == Op::Add) {
+            // Standalone activation or add: a 1x1 identity pool applies it
+            FusedGroup standalone;
+            standalone.nodes = {n};
+            standalone.output = n;
+            standalone.input = operand;
+            standalone.skip = other;
+            groups.push_back(standalone);
+
+            LayerDesc identity = LayerDesc::avgPool2d(1, 1);
+            if (node.op == Op::Activation) {
+                identity.activation = node.desc.activation;
+            }
+            layers.push_back(identity);
+            continue;
+        }
+
+        std::cerr << "[ERROR] LayerGraph: " << opName(node.op) << " node " << n
+                  << " cannot be fused into its producer"
+                  << (node.op == Op::Softmax ? " (softmax needs a dense producer)\n" : "\n");
+        return false;
+    }
+
+    if (groups.empty()) {
+        std::cerr << "[ERROR] LayerGraph: graph has no layers\n";
+        return false;
+    }
+
+    // Lowered network must be a chain: each group reads the previous group's output.
+    // Skip operands must be materialized: the graph input (topology layer 0) or the
+    // output of an earlier group g (topology layer g + 1).
+    for (size_t g = 0; g < groups.size(); ++g) {
+        const int expected = g == 0 ? 0 : groups[g - 1].output;
+        if (groups[g].input != expected) {
+            std::cerr << "[ERROR] LayerGraph: node " << groups[g].nodes[0]
+                      << " does not read the previous layer's output (branches are not supported)\n";
+            return false;
+        }
+
+        const int skip = groups[g].skip;
+        if (skip < 0) {
+            continue;
+        }
+        int32_t source = skip == 0 ? 0 : -1;
+        for (size_t s = 0; s < g && source < 0; ++s) {
+            if (groups[s].output == skip) {
+                source = static_cast<int32_t>(s + 1);
+            }
+        }
+        if (source < 0) {
+            std::cerr << "[ERROR] LayerGraph: Add node " << groups[g].output << " skip operand "
+                      << skip << " is not the input or a layer output\n";
+            return false;
+        }
+        layers[g].residualFrom = source;
+    }
+
+    // The last group's value is the network output; anything else unused is an error
+    for (size_t n = 0; n < m_nodes.size(); ++n) {
+        if (consumers[n] == 0 && static_cast<int>(n) != groups.back().output) {
+            std::cerr << "[ERROR] LayerGraph: " << opName(m_nodes[n].op) << " node " << n
+                      << " is never used\n";
+            return false;
+        }
+    }
+
+    m_groups = groups;
+    m_layers = layers;
+    m_inputShape = m_nodes[0].shape;
+
+    std::cout << "[INFO] LayerGraph: " << (m_nodes.size() - 1) << " ops fused into "
+              << m_groups.size() << " dispatch(es)\n";
+    return true;
+}
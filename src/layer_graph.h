@@ -0,0 +1,101 @@
+#pragma once
+
+#include "layer_desc.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Small graph IR for networks, lowered to one LayerDesc per fused group
+ *
+ * Nodes are added in topological order (every input must already exist). compile()
+ * infers shapes and runs the fusion pass: elementwise nodes (activation, softmax, add)
+ * are merged into the kernel of the producer (dense, conv, pool) that feeds them, so
+ * each fused group costs one dispatch and one barrier in NeuralCompute::forward().
+ *
+ * Fusion rules (kernel order is act(producer(x) + skip)):
+ * - An elementwise node fuses only if its producer's value has no other consumer
+ * - Add fuses before any activation; activation/softmax fuse once per group
+ * - Softmax fuses into dense producers only
+ * - An activation that cannot fuse becomes a 1x1 identity pool with that activation,
+ *   an Add that cannot fuse becomes a 1x1 identity pool with a residual input
+ *
+ * The lowered network is a chain: each group reads the previous group's output. The
+ * skip operand of an Add may be the graph input or any earlier group's output; it is
+ * lowered to LayerDesc::residualFrom and read in place by the layer kernel.
+ *
+ * Example:
+ *   LayerGraph graph;
+ *   int x = graph.addInput({1, 8, 8});
+ *   x = graph.addActivation(graph.addConv2D(x, 4, 3, 1, 1), 0);   // conv + ReLU: 1 dispatch
+ *   x = graph.addSoftmax(graph.addDense(x, 10));                  // dense + softmax: 1 dispatch
+ *   graph.compile();
+ *   buffers.initialize(graph.getInputShape(), graph.getLayers());
+ */
+class LayerGraph {
+public:
+    enum class Op : uint32_t {
+        Input,
+        Dense,
+        Conv2D,
+        MaxPool2D,
+        AvgPool2D,
+        Add,            // Elementwise sum of two same-sized tensors
+        Activation,     // Elementwise ReLU/Sigmoid/Tanh/Linear (NeuralBuffers::Activation)
+        Softmax         // Over the whole tensor
+    };
+
+    struct Node {
+        Op op = Op::Input;
+        std::vector<int> inputs;
+        LayerDesc desc;             // Producer parameters; desc.activation for Op::Activation
+        TensorShape shape;          // Output shape, filled in by compile()
+    };
+
+    /**
+     * @brief One dispatch of the lowered network
+     */
+    struct FusedGroup {
+        std::vector<int> nodes;     // Producer first, then the elementwise nodes merged into it
+        int output = -1;            // Node whose value the dispatch writes
+        int input = -1;             // Node the dispatch reads as its layer input
+        int skip = -1;              // Second operand of a fused Add, -1 if none
+    };
+
+    /**
+     * @brief Add a graph input (exactly one, added first)
+     * @return Node index
+     */
+    int addInput(const TensorShape& shape);
+
+    int addDense(int input, uint32_t units);
+    int addConv2D(int input, uint32_t outChannels, uint32_t kernelSize, uint32_t stride, uint32_t padding);
+    int addMaxPool2D(int input, uint32_t kernelSize, uint32_t stride, uint32_t padding = 0);
+    int addAvgPool2D(int input, uint32_t kernelSize, uint32_t stride, uint32_t padding = 0);
+    int addAdd(int a, int b);
+    int addActivation(int input, uint32_t activation);
+    int addSoftmax(int input);
+
+    /**
+     * @brief Infer shapes, fuse elementwise nodes and lower to layer descriptors
+     * @return false if the graph is malformed or cannot be lowered to a chain of groups
+     */
+    bool compile();
+
+    const std::vector<Node>& getNodes() const { return m_nodes; }
+    const std::vector<FusedGroup>& getGroups() const { return m_groups; }
+
+    /**
+     * @brief Lowered network, valid after compile() (one LayerDesc per fused group)
+     */
+    const TensorShape& getInputShape() const { return m_inputShape; }
+    const std::vector<LayerDesc>& getLayers() const { return m_layers; }
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<FusedGroup> m_groups;
+    std::vector<LayerDesc> m_layers;
+    TensorShape m_inputShape;
+
+    int addNode(Op op, std::vector<int> inputs, const LayerDesc& desc);
+    bool inferShapes();
+};
@@ -3,7 +3,11 @@
 #include "nn_compute.h"
 #include "renderer.h"
 #include "camera.h"
+#include "model_file.h"
+#include "layer_graph.h"
+#include <cmath>
 #include <iostream>
+#include <string>
 #include <vector>
 
 /**
@@ -14,6 +18,14 @@
  * - GPU-accelerated forward propagation
  * - Interactive camera controls
  * - Color-coded neuron activations
+ *
+ * Usage:
+ *   nn-visualizer                      Built-in XOR network
+ *   nn-visualizer --model FILE.nvm     Load a memory-mapped binary model
+ *   nn-visualizer --model FILE --stream  Stream layer weights from the file (out-of-core)
+ *   nn-visualizer --save-model FILE    Write the built-in XOR network as a model file
+ *   nn-visualizer --cnn                Small demo CNN (1x8x8 -> conv -> max pool -> conv -> dense softmax)
+ *   nn-visualizer --binary             XOR on binarized (XNOR-popcount) layers
  */
 
 // Global state for mouse input
@@ -70,7 +82,7 @@ void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "===========================================\n";
     std::cout << "GPU Neural Network Visualizer - XOR Demo\n";
     std::cout << "===========================================\n\n";
@@ -96,42 +108,171 @@ int main() {
     glfwSetScrollCallback(context.getWindow(), scrollCallback);
 
     // ========================================
-    // 2. Create XOR Neural Network
+    // 2. Create Neural Network
     // ========================================
-    std::cout << "\n[INFO] Setting up XOR network (2 -> 2 -> 1)\n";
-
-    // Network topology: 2 inputs -> 2 hidden -> 1 output
-    std::vector<uint32_t> topology = {2, 2, 1};
-    std::vector<uint32_t> activations = {0, 0};  // ReLU for all layers
+    std::string modelPath;
+    std::string saveModelPath;
+    bool streamWeights = false;
+    bool demoCnn = false;
+    bool demoBinary = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--model" && i + 1 < argc) {
+            modelPath = argv[++i];
+        } else if (arg == "--stream") {
+            streamWeights = true;
+        } else if (arg == "--cnn") {
+            demoCnn = true;
+        } else if (arg == "--binary") {
+            demoBinary = true;
+        } else if (arg == "--save-model" && i + 1 < argc) {
+            saveModelPath = argv[++i];
+        } else {
+            std::cerr << "[WARNING] Ignoring unknown argument: " << arg << "\n";
+        }
+    }
 
     NeuralBuffers buffers;
-    buffers.initialize(topology, activations);
-
-    // XOR weights (hand-crafted for demonstration)
-    // Layer 0: 2x2 = 4 weights
-    // Layer 1: 2x1 = 2 weights
-    std::vector<float> weights = {
-        // Layer 0 weights (2 inputs -> 2 hidden neurons)
-        1.0f, 1.0f,    // Hidden neuron 0: w0, w1
-        1.0f, 1.0f,    // Hidden neuron 1: w0, w1
-
-        // Layer 1 weights (2 hidden -> 1 output neuron)
-        1.0f, -2.0f    // Output neuron: w0, w1
-    };
+    ModelFile model;
 
-    // XOR biases
-    // Layer 0: 2 biases (one per hidden neuron)
-    // Layer 1: 1 bias (one for output neuron)
-    std::vector<float> biases = {
-        0.0f, -1.5f,   // Layer 0 biases
-        0.0f           // Layer 1 bias
-    };
+    if (!modelPath.empty()) {
+        // Weights stay in the mapped file and are uploaded without a host copy
+        if (!model.open(modelPath)) {
+            std::cerr << "[ERROR] Failed to load model: " << modelPath << "\n";
+            return -1;
+        }
+
+        NeuralBuffers::Config bufferConfig;
+        bufferConfig.streamWeights = streamWeights;
+        buffers.setConfig(bufferConfig);
+
+        if (!buffers.initialize(model.getInputShape(), model.getLayers()) ||
+            !model.uploadTo(buffers)) {
+            return -1;
+        }
+
+        std::cout << "[INFO] Network loaded with " << model.getWeightCount()
+                  << " weights and " << model.getBiasCount() << " biases\n";
+    } else if (demoCnn) {
+        std::cout << "\n[INFO] Setting up demo CNN (1x8x8 -> 4x8x8 -> 4x4x4 -> 8x4x4 -> 10)\n";
+
+        TensorShape inputShape;
+        inputShape.height = 8;
+        inputShape.width = 8;
+
+        // Activations and softmax fuse into their producers: 4 dispatches for 7 ops
+        const uint32_t relu = static_cast<uint32_t>(NeuralBuffers::Activation::ReLU);
+        LayerGraph graph;
+        int x = graph.addInput(inputShape);
+        x = graph.addActivation(graph.addConv2D(x, 4, 3, 1, 1), relu);  // 3x3, same padding
+        x = graph.addMaxPool2D(x, 2, 2);                                // 2x2 max pool
+        x = graph.addActivation(graph.addConv2D(x, 8, 3, 1, 1), relu);
+        graph.addSoftmax(graph.addDense(x, 10));
+
+        if (!graph.compile() || !buffers.initialize(graph.getInputShape(), graph.getLayers())) {
+            return -1;
+        }
+
+        // Deterministic pseudo-random parameters in [-0.5, 0.5)
+        auto fill = [](std::vector<float>& values, size_t count, float seed) {
+            values.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                float x = std::sin(static_cast<float>(i) * 12.9898f + seed) * 43758.5453f;
+                values[i] = x - std::floor(x) - 0.5f;
+            }
+        };
+        std::vector<float> weights, biases;
+        fill(weights, static_cast<size_t>(buffers.getTotalWeightCount()), 1.0f);
+        fill(biases, static_cast<size_t>(buffers.getTotalBiasCount()), 2.0f);
+
+        buffers.uploadWeights(weights);
+        buffers.uploadBiases(biases);
 
-    buffers.uploadWeights(weights);
-    buffers.uploadBiases(biases);
+        if (!saveModelPath.empty()) {
+            std::cerr << "[WARNING] Model files store dense topologies only, --save-model ignored\n";
+        }
+
+        std::cout << "[INFO] Network initialized with " << weights.size()
+                  << " weights and " << biases.size() << " biases\n";
+    } else if (demoBinary) {
+        std::cout << "\n[INFO] Setting up binarized XOR network (2 -> 2 -> 1, XNOR-popcount)\n";
+
+        // Inputs 0/1 binarize to -1/+1, so each layer sees sign sums:
+        // hidden 0 = a + b + 1 (> 0 for OR), hidden 1 = a + b - 1 (> 0 for AND),
+        // output = OR - AND - 1 (> 0 only for exactly one input set)
+        TensorShape inputShape;
+        inputShape.channels = 2;
+
+        const uint32_t relu = static_cast<uint32_t>(NeuralBuffers::Activation::ReLU);
+        std::vector<LayerDesc> layers = {
+            LayerDesc::binaryDense(2, relu),
+            LayerDesc::binaryDense(1, relu)
+        };
+        if (!buffers.initialize(inputShape, layers)) {
+            return -1;
+        }
+
+        // Only signs survive binarization; |w| = 1 keeps every row scale at 1
+        std::vector<float> weights = {
+            1.0f, 1.0f,    // Hidden 0: OR
+            1.0f, 1.0f,    // Hidden 1: AND
+            1.0f, -1.0f    // Output: OR and not AND
+        };
+        std::vector<float> biases = {
+            1.0f, -1.0f,   // Layer 0 biases
+            -1.0f          // Layer 1 bias
+        };
+
+        buffers.uploadWeights(weights);
+        buffers.uploadBiases(biases);
+
+        if (!saveModelPath.empty()) {
+            std::cerr << "[WARNING] Model files store dense topologies only, --save-model ignored\n";
+        }
+
+        std::cout << "[INFO] Network initialized with " << weights.size()
+                  << " binarized weights and " << biases.size() << " biases\n";
+    } else {
+        std::cout << "\n[INFO] Setting up XOR network (2 -> 2 -> 1)\n";
 
-    std::cout << "[INFO] Network initialized with " << weights.size()
-              << " weights and " << biases.size() << " biases\n";
+        // Network topology: 2 inputs -> 2 hidden -> 1 output
+        std::vector<uint32_t> topology = {2, 2, 1};
+        std::vector<uint32_t> activations = {0, 0};  // ReLU for all layers
+
+        if (!buffers.initialize(topology, activations)) {
+            return -1;
+        }
+
+        // XOR weights (hand-crafted for demonstration)
+        // Layer 0: 2x2 = 4 weights
+        // Layer 1: 2x1 = 2 weights
+        std::vector<float> weights = {
+            // Layer 0 weights (2 inputs -> 2 hidden neurons)
+            1.0f, 1.0f,    // Hidden neuron 0: w0, w1
+            1.0f, 1.0f,    // Hidden neuron 1: w0, w1
+
+            // Layer 1 weights (2 hidden -> 1 output neuron)
+            1.0f, -2.0f    // Output neuron: w0, w1
+        };
+
+        // XOR biases
+        // Layer 0: 2 biases (one per hidden neuron)
+        // Layer 1: 1 bias (one for output neuron)
+        std::vector<float> biases = {
+            0.0f, -1.5f,   // Layer 0 biases
+            0.0f           // Layer 1 bias
+        };
+
+        buffers.uploadWeights(weights);
+        buffers.uploadBiases(biases);
+
+        if (!saveModelPath.empty()) {
+            ModelFile::write(saveModelPath, topology, activations, weights, biases);
+        }
+
+        std::cout << "[INFO] Network initialized with " << weights.size()
+                  << " weights and " << biases.size() << " biases\n";
+    }
 
     // ========================================
     // 3. Initialize Compute Shader
@@ -157,8 +298,9 @@ int main() {
     Camera camera;
     g_camera = &camera;
 
-    // Center camera on network (middle layer)
-    camera.setTarget(glm::vec3(3.0f, 0.0f, 0.0f));
+    // Center camera on network (middle layer, 3.0 units between layers)
+    float networkCenterX = static_cast<float>(buffers.getTopology().size() - 1) * 3.0f / 2.0f;
+    camera.setTarget(glm::vec3(networkCenterX, 0.0f, 0.0f));
     camera.zoom(0.0f);  // Set initial distance
 
     // ========================================
@@ -186,6 +328,19 @@ int main() {
         {{1.0f, 1.0f}, "(1,1) -> 0"}
     };
 
+    // Loaded models with other input sizes get generic probe inputs on keys 1-4
+    const uint32_t inputSize = buffers.getTopology()[0];
+    if (inputSize != 2) {
+        tests.clear();
+        std::vector<float> zeros(inputSize, 0.0f), ones(inputSize, 1.0f);
+        std::vector<float> alternating(inputSize), ramp(inputSize);
+        for (uint32_t i = 0; i < inputSize; ++i) {
+            alternating[i] = static_cast<float>(i % 2);
+            ramp[i] = static_cast<float>(i) / static_cast<float>(inputSize);
+        }
+        tests = {{zeros, "zeros"}, {ones, "ones"}, {alternating, "alternating"}, {ramp, "ramp"}};
+    }
+
     int currentTest = 1;  // Start with (0,1) which has non-zero output
     size_t currentLayer = 0;  // Track which layer to compute next
     size_t totalLayers = compute.getLayerCount();
@@ -0,0 +1,399 @@
+#include "model_file.h"
+#include "nn_buffers.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint64_t kUploadChunkBytes = 64ull << 20;    // 64 MB per driver copy
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+ModelFile::~ModelFile() {
+    close();
+}
+
+bool ModelFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "[ERROR] Failed to open model file: " << path << "\n";
+        return false;
+    }
+    m_fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        std::cerr << "[ERROR] Empty or unreadable model file: " << path << "\n";
+        close();
+        return false;
+    }
+    m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        std::cerr << "[ERROR] Failed to map model file: " << path << "\n";
+        close();
+        return false;
+    }
+    m_mappingHandle = mapping;
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        std::cerr << "[ERROR] Failed to open model file: " << path << "\n";
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(m_fd, &st) != 0 || st.st_size == 0) {
+        std::cerr << "[ERROR] Empty or unreadable model file: " << path << "\n";
+        close();
+        return false;
+    }
+    m_size = static_cast<uint64_t>(st.st_size);
+
+    void* mapped = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    m_data = mapped == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(mapped);
+    if (m_data) {
+        madvise(mapped, m_size, MADV_SEQUENTIAL);
+    }
+#endif
+
+    if (!m_data) {
+        std::cerr << "[ERROR] Failed to map model file: " << path << "\n";
+        close();
+        return false;
+    }
+
+    if (!validate()) {
+        std::cerr << "[ERROR] Invalid model file: " << path << "\n";
+        close();
+        return false;
+    }
+
+    std::cout << "[INFO] Model file mapped: " << path << " (" << m_size << " bytes, "
+              << m_header.weightCount << " weights, " << m_header.biasCount << " biases)\n";
+    return true;
+}
+
+void ModelFile::close() {
+#ifdef _WIN32
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mappingHandle) {
+        CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+        m_mappingHandle = nullptr;
+    }
+    if (m_fileHandle) {
+        CloseHandle(static_cast<HANDLE>(m_fileHandle));
+        m_fileHandle = nullptr;
+    }
+#else
+    if (m_data) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_header = {};
+    m_topology.clear();
+    m_activations.clear();
+    m_ranks.clear();
+    m_ties.clear();
+}
+
+bool ModelFile::validate() {
+    if (m_size < sizeof(ModelFileHeader)) {
+        std::cerr << "[ERROR] Model file too small for header\n";
+        return false;
+    }
+
+    std::memcpy(&m_header, m_data, sizeof(ModelFileHeader));
+
+    if (m_header.magic != kMagic) {
+        std::cerr << "[ERROR] Bad model file magic\n";
+        return false;
+    }
+    if (m_header.version != kVersion) {
+        std::cerr << "[ERROR] Unsupported model file version " << m_header.version
+                  << " (expected " << kVersion << ")\n";
+        return false;
+    }
+    if (m_header.layerCount < 2 || m_header.fileSize != m_size ||
+        (m_header.flags & ~(kFlagLowRank | kFlagTied)) != 0) {
+        std::cerr << "[ERROR] Corrupt model file header\n";
+        return false;
+    }
+
+    // Topology + activation (+ rank) (+ tie) tables follow the header
+    const bool lowRank = (m_header.flags & kFlagLowRank) != 0;
+    const bool tied = (m_header.flags & kFlagTied) != 0;
+    const uint64_t perLayerTables = 1 + (lowRank ? 1 : 0) + (tied ? 1 : 0);
+    const uint64_t tableBytes = (m_header.layerCount + perLayerTables * (m_header.layerCount - 1)) * sizeof(uint32_t);
+    if (sizeof(ModelFileHeader) + tableBytes > m_size) {
+        std::cerr << "[ERROR] Model file truncated in layer table\n";
+        return false;
+    }
+
+    const uint8_t* table = m_data + sizeof(ModelFileHeader);
+    m_topology.resize(m_header.layerCount);
+    m_activations.resize(m_header.layerCount - 1);
+    std::memcpy(m_topology.data(), table, m_topology.size() * sizeof(uint32_t));
+    std::memcpy(m_activations.data(), table + m_topology.size() * sizeof(uint32_t),
+                m_activations.size() * sizeof(uint32_t));
+    const uint8_t* layerTable = table + (m_topology.size() + m_activations.size()) * sizeof(uint32_t);
+    m_ranks.assign(m_activations.size(), 0);
+    if (lowRank) {
+        std::memcpy(m_ranks.data(), layerTable, m_ranks.size() * sizeof(uint32_t));
+        layerTable += m_ranks.size() * sizeof(uint32_t);
+    }
+    m_ties.assign(m_activations.size(), 0);
+    if (tied) {
+        std::memcpy(m_ties.data(), layerTable, m_ties.size() * sizeof(uint32_t));
+    }
+
+    // Ties must name an earlier untied, full-rank dense layer; tools index by them before
+    // NeuralBuffers ever sees the layers, and a tied layer cannot also be low-rank
+    for (size_t i = 0; i < m_ties.size(); ++i) {
+        if (m_ties[i] == 0) continue;
+        const uint32_t source = (m_ties[i] & ~kTiedTransposed) - 1;
+        if (m_ranks[i] != 0 || (m_ties[i] & ~kTiedTransposed) == 0 || source >= i ||
+            m_ties[source] != 0 || m_ranks[source] != 0) {
+            std::cerr << "[ERROR] Corrupt tie table entry for layer " << i << "\n";
+            return false;
+        }
+    }
+
+    // Counts must match what NeuralBuffers::computeOffsets will allocate
+    uint64_t expectedWeights = 0;
+    uint64_t expectedBiases = 0;
+    const TensorShape inputShape = getInputShape();
+    const std::vector<LayerDesc> layers = getLayers();
+    TensorShape shape = inputShape;
+    for (const LayerDesc& desc : layers) {
+        expectedWeights += layerWeightCount(shape, desc);
+        expectedBiases += layerBiasCount(desc);
+        shape = layerOutputShape(shape, desc);
+    }
+    if (expectedWeights != m_header.weightCount || expectedBiases != m_header.biasCount) {
+        std::cerr << "[ERROR] Model blob sizes do not match topology\n";
+        return false;
+    }
+
+    const uint64_t weightBytes = m_header.weightCount * sizeof(float);
+    const uint64_t biasBytes = m_header.biasCount * sizeof(float);
+
+    // Written as remaining-size comparisons so a crafted offset cannot wrap around
+    if (m_header.weightsOffset % kBlobAlignment != 0 || m_header.biasesOffset % kBlobAlignment != 0 ||
+        m_header.weightsOffset > m_size || weightBytes > m_size - m_header.weightsOffset ||
+        m_header.biasesOffset > m_size || biasBytes > m_size - m_header.biasesOffset) {
+        std::cerr << "[ERROR] Model blob offsets out of range or misaligned\n";
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<LayerDesc> ModelFile::getLayers() const {
+    std::vector<LayerDesc> layers;
+    for (size_t i = 0; i < m_activations.size(); ++i) {
+        const uint32_t rank = i < m_ranks.size() ? m_ranks[i] : 0;
+        const uint32_t tie = i < m_ties.size() ? m_ties[i] : 0;
+        if (tie != 0) {
+            layers.push_back(LayerDesc::tiedDense(m_topology[i + 1], (tie & ~kTiedTransposed) - 1,
+                                                  (tie & kTiedTransposed) != 0, m_activations[i]));
+        } else {
+            layers.push_back(rank > 0 ? LayerDesc::lowRankDense(m_topology[i + 1], rank, m_activations[i])
+                                      : LayerDesc::dense(m_topology[i + 1], m_activations[i]));
+        }
+    }
+    return layers;
+}
+
+TensorShape ModelFile::getInputShape() const {
+    TensorShape shape;
+    shape.channels = m_topology.empty() ? 0 : m_topology[0];
+    return shape;
+}
+
+const float* ModelFile::getWeights() const {
+    if (!m_data) return nullptr;
+    return reinterpret_cast<const float*>(m_data + m_header.weightsOffset);
+}
+
+const float* ModelFile::getBiases() const {
+    if (!m_data) return nullptr;
+    return reinterpret_cast<const float*>(m_data + m_header.biasesOffset);
+}
+
+void ModelFile::prefetch(uint64_t offset, uint64_t size) const {
+    if (!m_data || offset >= m_size) return;
+    size = std::min(size, m_size - offset);
+
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<uint8_t*>(m_data + offset);
+    range.NumberOfBytes = static_cast<SIZE_T>(size);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // madvise needs a page-aligned start address
+    const uint64_t pageStart = offset / kBlobAlignment * kBlobAlignment;
+    madvise(const_cast<uint8_t*>(m_data + pageStart), size + (offset - pageStart), MADV_WILLNEED);
+#endif
+}
+
+bool ModelFile::uploadTo(NeuralBuffers& buffers) const {
+    if (!m_data) {
+        std::cerr << "[ERROR] Model file not open\n";
+        return false;
+    }
+    if (buffers.getTopology() != m_topology || buffers.getTotalWeightCount() != m_header.weightCount) {
+        std::cerr << "[ERROR] Model topology does not match initialized buffers\n";
+        return false;
+    }
+
+    // Streaming mode: layers are paged in from the mapping on demand
+    if (buffers.isStreaming()) {
+        buffers.setStreamingSource(getWeights(), static_cast<size_t>(m_header.weightCount));
+        buffers.uploadBiases(getBiases(), static_cast<size_t>(m_header.biasCount));
+        return true;
+    }
+
+    const float* weights = getWeights();
+
+    // Transposed/tiled/padded/reduced-precision/low-rank storage is converted per layer, and
+    // folded batch norm / input normalization needs whole layers too
+    if (buffers.hasRepackedStorage() || buffers.hasFolding()) {
+        const auto& layerInfo = buffers.getLayerInfo();
+        for (size_t layer = 0; layer < layerInfo.size(); ++layer) {
+            const uint64_t start = buffers.getLayerWeightStart(layer);
+            const uint64_t count = buffers.getLayerWeightCount(layer);
+            prefetch(m_header.weightsOffset + (start + count) * sizeof(float), kUploadChunkBytes);
+            if (!buffers.uploadWeights(weights + start, static_cast<size_t>(count), static_cast<size_t>(start))) {
+                return false;
+            }
+        }
+        buffers.uploadBiases(getBiases(), static_cast<size_t>(m_header.biasCount));
+        return true;
+    }
+
+    // Weights: chunked so the next chunk is read from disk while the
+    // driver copies the current one
+    const uint64_t chunkFloats = kUploadChunkBytes / sizeof(float);
+    prefetch(m_header.weightsOffset, kUploadChunkBytes);
+
+    for (uint64_t offset = 0; offset < m_header.weightCount; offset += chunkFloats) {
+        const uint64_t count = std::min(chunkFloats, m_header.weightCount - offset);
+        prefetch(m_header.weightsOffset + (offset + count) * sizeof(float), kUploadChunkBytes);
+        if (!buffers.uploadWeights(weights + offset, static_cast<size_t>(count), static_cast<size_t>(offset))) {
+            return false;
+        }
+    }
+
+    buffers.uploadBiases(getBiases(), static_cast<size_t>(m_header.biasCount));
+    return true;
+}
+
+bool ModelFile::write(const std::string& path,
+                      const std::vector<uint32_t>& topology,
+                      const std::vector<uint32_t>& activations,
+                      const std::vector<float>& weights,
+                      const std::vector<float>& biases,
+                      const std::vector<uint32_t>& ranks,
+                      const std::vector<uint32_t>& ties) {
+    if (topology.size() < 2 || activations.size() != topology.size() - 1 ||
+        (!ranks.empty() && ranks.size() != activations.size()) ||
+        (!ties.empty() && ties.size() != activations.size())) {
+        std::cerr << "[ERROR] ModelFile::write: invalid topology\n";
+        return false;
+    }
+
+    // Plain dense models keep the original table layout
+    const bool lowRank = std::any_of(ranks.begin(), ranks.end(), [](uint32_t rank) { return rank > 0; });
+    const bool tied = std::any_of(ties.begin(), ties.end(), [](uint32_t tie) { return tie != 0; });
+
+    ModelFileHeader header{};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.layerCount = static_cast<uint32_t>(topology.size());
+    header.flags = (lowRank ? kFlagLowRank : 0) | (tied ? kFlagTied : 0);
+    header.weightCount = weights.size();
+    header.biasCount = biases.size();
+
+    const uint64_t tableEnd = sizeof(ModelFileHeader) +
+                              (topology.size() + activations.size() + (lowRank ? ranks.size() : 0) +
+                               (tied ? ties.size() : 0)) *
+                              sizeof(uint32_t);
+    header.weightsOffset = alignUp(tableEnd, kBlobAlignment);
+    header.biasesOffset = alignUp(header.weightsOffset + weights.size() * sizeof(float), kBlobAlignment);
+    header.fileSize = header.biasesOffset + biases.size() * sizeof(float);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[ERROR] Failed to create model file: " << path << "\n";
+        return false;
+    }
+
+    auto padTo = [&file](uint64_t offset) {
+        const uint64_t pos = static_cast<uint64_t>(file.tellp());
+        std::vector<char> zeros(offset - pos, 0);
+        file.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(topology.data()),
+               static_cast<std::streamsize>(topology.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(activations.data()),
+               static_cast<std::streamsize>(activations.size() * sizeof(uint32_t)));
+    if (lowRank) {
+        file.write(reinterpret_cast<const char*>(ranks.data()),
+                   static_cast<std::streamsize>(ranks.size() * sizeof(uint32_t)));
+    }
+    if (tied) {
+        file.write(reinterpret_cast<const char*>(ties.data()),
+                   static_cast<std::streamsize>(ties.size() * sizeof(uint32_t)));
+    }
+
+    padTo(header.weightsOffset);
+    file.write(reinterpret_cast<const char*>(weights.data()),
+               static_cast<std::streamsize>(weights.size() * sizeof(float)));
+
+    padTo(header.biasesOffset);
+    file.write(reinterpret_cast<const char*>(biases.data()),
+               static_cast<std::streamsize>(biases.size() * sizeof(float)));
+
+    if (!file.good()) {
+        std::cerr << "[ERROR] Failed to write model file: " << path << "\n";
+        return false;
+    }
+
+    std::cout << "[INFO] Model file written: " << path << " (" << header.fileSize << " bytes)\n";
+    return true;
+}
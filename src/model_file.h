@@ -0,0 +1,148 @@
+#pragma once
+
+#include "layer_desc.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class NeuralBuffers;
+
+/**
+ * @brief Memory-mapped binary model file (.nvm)
+ *
+ * File Layout (little-endian):
+ * - Header (64 bytes, see ModelFileHeader)
+ * - Topology:    uint32[layerCount]
+ * - Activations: uint32[layerCount - 1]
+ * - Ranks:       uint32[layerCount - 1], only with kFlagLowRank (0 = full dense layer,
+ *                r = LayerKind::LowRankDense with U [out][r] then V [r][in] in the weights blob)
+ * - Ties:        uint32[layerCount - 1], only with kFlagTied (0 = own weights, otherwise
+ *                source layer + 1, with kTiedTransposed set for a transposed tie; the
+ *                source is an earlier untied full-rank layer, and a tied layer has rank 0
+ *                and no entries in the weights blob, see LayerDesc::tiedTo)
+ * - Weights blob at weightsOffset (page aligned), NeuralBuffers::computeOffsets order
+ * - Biases blob at biasesOffset (page aligned), NeuralBuffers::computeOffsets order
+ *
+ * The file is mapped read-only and the blobs are passed straight to
+ * NeuralBuffers::uploadWeights/uploadBiases - no intermediate std::vector copy.
+ */
+class ModelFile {
+public:
+    static constexpr uint32_t kMagic = 0x5349564E;       // "NVIS" read as little-endian
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint64_t kBlobAlignment = 4096;     // Page alignment for blobs
+    static constexpr uint32_t kFlagLowRank = 1u;         // A rank table follows the activations
+    static constexpr uint32_t kFlagTied = 2u;            // A tie table follows (after the ranks, if any)
+    static constexpr uint32_t kTiedTransposed = 0x80000000u;
+
+    struct ModelFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t layerCount;       // Number of entries in topology
+        uint32_t flags;            // kFlag* bits, all others must be 0
+        uint64_t weightCount;      // In floats
+        uint64_t biasCount;        // In floats
+        uint64_t weightsOffset;    // Byte offset of weights blob
+        uint64_t biasesOffset;     // Byte offset of biases blob
+        uint64_t fileSize;         // Total file size in bytes
+        uint64_t _reserved;
+    };
+    static_assert(sizeof(ModelFileHeader) == 64, "ModelFileHeader must be 64 bytes");
+
+    ModelFile() = default;
+    ~ModelFile();
+
+    // Prevent copying (owns the mapping)
+    ModelFile(const ModelFile&) = delete;
+    ModelFile& operator=(const ModelFile&) = delete;
+
+    /**
+     * @brief Map a model file and validate its header
+     * @param path Path to .nvm file
+     * @return true if the file is a valid model
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+
+    /**
+     * @brief Upload weights and biases into already-initialized buffers
+     *
+     * Streams the mapped blobs in chunks, prefetching the next chunk from disk
+     * while the driver copies the current one. Repacked storage and folded batch
+     * norm / input normalization are uploaded one whole layer at a time instead.
+     * @return false if the buffers' topology does not match the file or a weight upload is rejected
+     */
+    bool uploadTo(NeuralBuffers& buffers) const;
+
+    /**
+     * @brief Write a model file
+     * @param ranks Per computed layer, 0 for dense; empty (or all 0) writes a plain dense model
+     * @param ties Per computed layer, tie table entry (0 = own weights); empty (or all 0) writes none
+     * @return true if written successfully
+     */
+    static bool write(const std::string& path,
+                      const std::vector<uint32_t>& topology,
+                      const std::vector<uint32_t>& activations,
+                      const std::vector<float>& weights,
+                      const std::vector<float>& biases,
+                      const std::vector<uint32_t>& ranks = {},
+                      const std::vector<uint32_t>& ties = {});
+
+    /**
+     * @brief Tie table entry for a layer (0 if it owns its weights)
+     */
+    static uint32_t tieEntry(const LayerDesc& desc) {
+        if (desc.tiedTo < 0) return 0;
+        return (static_cast<uint32_t>(desc.tiedTo) + 1) | (desc.tiedTransposed ? kTiedTransposed : 0);
+    }
+
+    bool isOpen() const { return m_data != nullptr; }
+
+    const std::vector<uint32_t>& getTopology() const { return m_topology; }
+    const std::vector<uint32_t>& getActivations() const { return m_activations; }
+    const std::vector<uint32_t>& getRanks() const { return m_ranks; }   // One per layer, 0 = dense
+    const std::vector<uint32_t>& getTies() const { return m_ties; }     // One per layer, 0 = own weights
+
+    /**
+     * @brief Layer descriptors for NeuralBuffers/CpuReference::initialize(getInputShape(), getLayers())
+     *
+     * Dense layers, or LayerDesc::lowRankDense where the file has a rank for the layer,
+     * or LayerDesc::tiedDense where it has a tie.
+     */
+    std::vector<LayerDesc> getLayers() const;
+    TensorShape getInputShape() const;
+
+    const float* getWeights() const;
+    const float* getBiases() const;
+    uint64_t getWeightCount() const { return m_header.weightCount; }
+    uint64_t getBiasCount() const { return m_header.biasCount; }
+
+    /**
+     * @brief Hint the OS to start reading a byte range of the file
+     */
+    void prefetch(uint64_t offset, uint64_t size) const;
+
+private:
+    const uint8_t* m_data = nullptr;   // Start of the read-only mapping
+    uint64_t m_size = 0;
+
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#else
+    int m_fd = -1;
+#endif
+
+    ModelFileHeader m_header{};
+    std::vector<uint32_t> m_topology;
+    std::vector<uint32_t> m_activations;
+    std::vector<uint32_t> m_ranks;
+    std::vector<uint32_t> m_ties;
+
+    bool validate();
+};
@@ -0,0 +1,205 @@
+#include "neuron_usage.h"
+#include "shader_loader.h"
+#include <algorithm>
+#include <iostream>
+
+NeuronUsage::~NeuronUsage() {
+    cleanup();
+}
+
+bool NeuronUsage::initialize(const std::string& shaderPath, NeuralBuffers& buffers) {
+    cleanup();
+
+    // Counting reads every layer's activations after the pass
+    if (buffers.getConfig().reuseActivations) {
+        std::cerr << "[ERROR] NeuronUsage needs every layer's activations (reuseActivations is set)\n";
+        return false;
+    }
+
+    m_countProgram = ShaderLoader::loadComputeShader(shaderPath);
+    if (m_countProgram == 0) {
+        std::cerr << "[ERROR] Failed to load compute shader: " << shaderPath << "\n";
+        return false;
+    }
+
+    m_buffers = &buffers;
+    const auto& topology = buffers.getTopology();
+    m_countOffsets.resize(topology.size());
+    m_neuronCount = 0;
+    for (size_t layer = 0; layer < topology.size(); ++layer) {
+        m_countOffsets[layer] = m_neuronCount;
+        m_neuronCount += topology[layer];
+    }
+
+    glGenBuffers(1, &m_countsSSBO);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countsSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_neuronCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_READ);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    reset();
+
+    std::cout << "[INFO] Neuron usage counters initialized (" << m_neuronCount << " neurons)\n";
+    return true;
+}
+
+void NeuronUsage::reset() {
+    if (!m_countsSSBO) return;
+
+    const uint32_t zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countsSSBO);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    m_sampleCount = 0;
+}
+
+void NeuronUsage::accumulate(NeuralCompute& compute, const std::vector<float>& inputs) {
+    if (!m_buffers || m_countProgram == 0) {
+        std::cerr << "[ERROR] NeuronUsage not initialized\n";
+        return;
+    }
+
+    m_buffers->setInputs(inputs);
+    compute.forward();
+
+    glUseProgram(m_countProgram);
+    m_buffers->bindBuffers(0, 1, 2);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, m_countsSSBO);
+
+    const GLint activationOffsetLoc = glGetUniformLocation(m_countProgram, "u_activationOffset");
+    const GLint countOffsetLoc = glGetUniformLocation(m_countProgram, "u_countOffset");
+    const GLint neuronCountLoc = glGetUniformLocation(m_countProgram, "u_neuronCount");
+
+    // Layers write disjoint counters, so no barrier is needed between their dispatches
+    const auto& topology = m_buffers->getTopology();
+    const auto& activationOffsets = m_buffers->getActivationOffsets();
+    const uint32_t workGroupSize = 256;  // Must match shader local_size_x
+    for (size_t layer = 0; layer < topology.size(); ++layer) {
+        glUniform1ui(activationOffsetLoc, activationOffsets[layer]);
+        glUniform1ui(countOffsetLoc, m_countOffsets[layer]);
+        glUniform1ui(neuronCountLoc, topology[layer]);
+        glDispatchCompute((topology[layer] + workGroupSize - 1) / workGroupSize, 1, 1);
+    }
+
+    // The next sample's forward pass overwrites the activations read here
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    m_sampleCount++;
+}
+
+void NeuronUsage::readCounts(std::vector<uint32_t>& counts) const {
+    counts.assign(m_neuronCount, 0);
+    if (!m_countsSSBO) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countsSSBO);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_neuronCount * sizeof(uint32_t), counts.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+bool NeuronUsage::compact(const std::vector<uint32_t>& topology,
+                          const std::vector<uint32_t>& activations,
+                          const std::vector<float>& weights,
+                          const std::vector<float>& biases,
+                          const std::vector<uint32_t>& counts,
+                          CompactNetwork& result) {
+    if (topology.size() < 2 || activations.size() != topology.size() - 1) {
+        std::cerr << "[ERROR] NeuronUsage::compact: invalid topology\n";
+        return false;
+    }
+
+    const size_t layerCount = activations.size();
+    std::vector<size_t> weightStart(layerCount + 1, 0);
+    std::vector<size_t> biasStart(layerCount + 1, 0);
+    std::vector<size_t> countStart(topology.size() + 1, 0);
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        weightStart[layer + 1] = weightStart[layer] + static_cast<size_t>(topology[layer + 1]) * topology[layer];
+        biasStart[layer + 1] = biasStart[layer] + topology[layer + 1];
+    }
+    for (size_t layer = 0; layer < topology.size(); ++layer) {
+        countStart[layer + 1] = countStart[layer] + topology[layer];
+    }
+    if (weights.size() != weightStart.back() || biases.size() != biasStart.back() ||
+        counts.size() != countStart.back()) {
+        std::cerr << "[ERROR] NeuronUsage::compact: parameter or count array does not match the topology\n";
+        return false;
+    }
+
+    // Input and output neurons always stay; hidden layers are decided from the output back
+    // so the zero-outgoing test only looks at connections to neurons that are kept
+    std::vector<std::vector<bool>> keep(topology.size());
+    for (size_t layer = 0; layer < topology.size(); ++layer) {
+        keep[layer].assign(topology[layer], true);
+    }
+
+    const uint32_t relu = static_cast<uint32_t>(NeuralBuffers::Activation::ReLU);
+    const uint32_t softmax = static_cast<uint32_t>(NeuralBuffers::Activation::Softmax);
+    for (size_t layer = topology.size() - 2; layer >= 1; --layer) {
+        // Softmax normalizes over the whole layer: every neuron affects the others
+        const uint32_t activation = activations[layer - 1];
+        if (activation == softmax) continue;
+
+        const uint32_t inputs = topology[layer];
+        const uint32_t outputs = topology[layer + 1];
+        const float* next = weights.data() + weightStart[layer];
+        size_t keptCount = 0;
+        for (uint32_t n = 0; n < inputs; ++n) {
+            const bool dead = activation == relu && counts[countStart[layer] + n] == 0;
+            bool connected = false;
+            for (uint32_t o = 0; o < outputs && !connected; ++o) {
+                connected = keep[layer + 1][o] && next[static_cast<size_t>(o) * inputs + n] != 0.0f;
+            }
+            keep[layer][n] = !dead && connected;
+            keptCount += keep[layer][n] ? 1 : 0;
+        }
+
+        // An empty layer cannot be represented; one zero neuron keeps the outputs unchanged
+        if (keptCount == 0) {
+            keep[layer][0] = true;
+        }
+    }
+
+    result = {};
+    result.activations = activations;
+    result.keptNeurons.resize(topology.size());
+    for (size_t layer = 0; layer < topology.size(); ++layer) {
+        for (uint32_t n = 0; n < topology[layer]; ++n) {
+            if (keep[layer][n]) result.keptNeurons[layer].push_back(n);
+        }
+        result.topology.push_back(static_cast<uint32_t>(result.keptNeurons[layer].size()));
+    }
+
+    // Kept rows of each layer, restricted to the kept columns (order is preserved)
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        const uint32_t inputs = topology[layer];
+        for (uint32_t o : result.keptNeurons[layer + 1]) {
+            const float* row = weights.data() + weightStart[layer] + static_cast<size_t>(o) * inputs;
+            for (uint32_t i : result.keptNeurons[layer]) {
+                result.weights.push_back(row[i]);
+            }
+            result.biases.push_back(biases[biasStart[layer] + o]);
+        }
+    }
+    return true;
+}
+
+bool NeuronUsage::rebuild(NeuralBuffers& buffers, const CompactNetwork& network) {
+    if (!buffers.initialize(network.topology, network.activations)) {
+        std::cerr << "[ERROR] Failed to rebuild buffers for the compacted topology\n";
+        return false;
+    }
+    buffers.uploadWeights(network.weights);
+    buffers.uploadBiases(network.biases);
+    return true;
+}
+
+void NeuronUsage::cleanup() {
+    if (m_countProgram) {
+        glDeleteProgram(m_countProgram);
+        m_countProgram = 0;
+    }
+    if (m_countsSSBO) {
+        glDeleteBuffers(1, &m_countsSSBO);
+        m_countsSSBO = 0;
+    }
+    m_buffers = nullptr;
+    m_countOffsets.clear();
+    m_neuronCount = 0;
+    m_sampleCount = 0;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "nn_buffers.h"
+#include "nn_compute.h"
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Dead-neuron detection and topology compaction for dense networks
+ *
+ * accumulate() runs samples through the GPU network and, after each forward pass,
+ * activation_count.comp adds one to a neuron's counter (uint SSBO at binding 7) when its
+ * activation is positive. A ReLU neuron whose counter stays 0 output exactly zero for
+ * every sample; compact() removes those and every hidden neuron whose outgoing weights
+ * are all zero, and rebuild() re-creates the buffers with the smaller topology.
+ *
+ * A removed neuron only ever added +-0 terms to the next layer, so with serial fp32
+ * accumulation (the default forward.comp and CpuReference paths) the outputs stay
+ * bit-identical on the counted samples. padToVec4 and reduced-precision layers sum in
+ * vec4/vec2 groups, which shift when inputs are removed - re-check those outputs.
+ */
+class NeuronUsage {
+public:
+    /**
+     * @brief Compacted network: dense topology and parameters in NeuralBuffers order
+     */
+    struct CompactNetwork {
+        std::vector<uint32_t> topology;
+        std::vector<uint32_t> activations;
+        std::vector<float> weights;            // Per layer [out][in]
+        std::vector<float> biases;
+        std::vector<std::vector<uint32_t>> keptNeurons;    // Per topology layer, original indices
+    };
+
+    NeuronUsage() = default;
+    ~NeuronUsage();
+
+    // Prevent copying
+    NeuronUsage(const NeuronUsage&) = delete;
+    NeuronUsage& operator=(const NeuronUsage&) = delete;
+
+    /**
+     * @brief Load the counting shader and create one zeroed counter per neuron
+     * @param shaderPath Path to activation_count.comp
+     * @param buffers Network to count (must keep every layer's activations: no reuseActivations)
+     * @return false if the shader fails to load or activations are not kept
+     */
+    bool initialize(const std::string& shaderPath, NeuralBuffers& buffers);
+
+    /**
+     * @brief Zero every counter
+     */
+    void reset();
+
+    /**
+     * @brief Run one sample through the network and count the neurons it activates
+     * @param compute Compute pipeline initialized with the same buffers
+     * @param inputs Input values
+     */
+    void accumulate(NeuralCompute& compute, const std::vector<float>& inputs);
+
+    /**
+     * @brief Read the counters (one per neuron, topology order without vec4 padding)
+     */
+    void readCounts(std::vector<uint32_t>& counts) const;
+
+    /**
+     * @brief Number of samples accumulated since the last reset()
+     */
+    uint32_t getSampleCount() const { return m_sampleCount; }
+
+    /**
+     * @brief Remove dead and disconnected hidden neurons
+     * @param topology Dense layer sizes (input first)
+     * @param activations Activation type per layer
+     * @param weights Flat weights, per layer [out][in]
+     * @param biases Flat biases
+     * @param counts Activation counts from readCounts()
+     * @param result Compacted network
+     * @return false if the arrays do not match the topology
+     *
+     * A hidden neuron is removed if its layer is ReLU and it never activated, or if all of
+     * its outgoing weights are zero. Layers are visited from the output back, so neurons
+     * that only fed removed ones go too. Input and output neurons and softmax layers are
+     * kept, as is at least one neuron per layer.
+     */
+    static bool compact(const std::vector<uint32_t>& topology,
+                        const std::vector<uint32_t>& activations,
+                        const std::vector<float>& weights,
+                        const std::vector<float>& biases,
+                        const std::vector<uint32_t>& counts,
+                        CompactNetwork& result);
+
+    /**
+     * @brief Re-initialize buffers with a compacted network and upload its parameters
+     *
+     * Keeps the buffers' Config. NeuralCompute (layer metadata) and the renderer must be
+     * initialized again afterwards.
+     */
+    static bool rebuild(NeuralBuffers& buffers, const CompactNetwork& network);
+
+private:
+    GLuint m_countProgram = 0;
+    GLuint m_countsSSBO = 0;
+    NeuralBuffers* m_buffers = nullptr;
+    std::vector<uint32_t> m_countOffsets;   // First counter of each topology layer
+    uint32_t m_neuronCount = 0;
+    uint32_t m_sampleCount = 0;
+
+    void cleanup();
+};
@@ -1,141 +1,1589 @@
 #include "nn_buffers.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <numeric>
+#include <sstream>
 
-NeuralBuffers::~NeuralBuffers() {
-    cleanup();
+namespace {
+
+// IEEE 754 binary16 conversion for FP16 weight storage (round to nearest even)
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    const uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent == 0xFFu) {
+        return sign | 0x7C00u | (mantissa ? 0x200u : 0u);     // Inf / NaN
+    }
+    const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if (halfExponent >= 31) {
+        return sign | 0x7C00u;                                  // Overflow to Inf
+    }
+    if (halfExponent <= 0) {
+        if (halfExponent < -10) {
+            return sign;                                        // Underflow to zero
+        }
+        // Subnormal: shift the implicit leading 1 into the mantissa
+        mantissa |= 0x800000u;
+        const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1u << shift) - 1u);
+        const uint32_t halfway = 1u << (shift - 1u);
+        if (rest > halfway || (rest == halfway && (half & 1u))) half++;
+        return sign | static_cast<uint16_t>(half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    const uint32_t rest = mantissa & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) half++;   // May carry into Inf
+    return sign | static_cast<uint16_t>(half);
 }
 
-void NeuralBuffers::initialize(const std::vector<uint32_t>& layerSizes,
-                                const std::vector<uint32_t>& activations) {
-    cleanup();  // Clean up any existing buffers
+float halfToFloat(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1Fu;
+    uint32_t mantissa = half & 0x3FFu;
+    uint32_t bits;
+    if (exponent == 0x1Fu) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Normalize the subnormal
+            exponent = 1;
+            while ((mantissa & 0x400u) == 0) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | ((exponent + 127 - 15) << 23) | ((mantissa & 0x3FFu) << 13);
+        }
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 32-bit words per row of a reduced-precision dense layer (INT8 includes the scale)
+uint64_t reducedRowWords(uint32_t precision, uint64_t inputSize) {
+    if (precision == static_cast<uint32_t>(NeuralBuffers::Precision::FP16)) {
+        return (inputSize + 1) / 2;
+    }
+    return 1 + (inputSize + 3) / 4;
+}
 
-    // Verify struct size matches std140 expectations (must be 32 bytes)
-    static_assert(sizeof(LayerInfo) == 32, "LayerInfo must be 32 bytes for std140 alignment");
+// Canonical weights of a conv layer, [outC][inC][ky][kx]; pooling layers have none
+uint64_t convWeightCount(const NeuralBuffers::LayerInfo& info) {
+    if (info.layerKind != static_cast<uint32_t>(LayerKind::Conv2D)) {
+        return 0;
+    }
+    return static_cast<uint64_t>(info.outputChannels) * info.inputChannels * info.kernelSize * info.kernelSize;
+}
 
-    m_topology = layerSizes;
+// Leading weights of a layer that belong to one output channel (foldChannels() outChannel):
+// all of them, except in a low-rank layer where only U's rows do and V is shared
+uint64_t outputChannelWeights(const NeuralBuffers::LayerInfo& info, uint64_t count) {
+    if (info.layerKind == static_cast<uint32_t>(LayerKind::LowRankDense)) {
+        return static_cast<uint64_t>(info.outputSize) * info.kernelSize;
+    }
+    return count;
+}
 
-    // Compute total neurons
-    m_totalNeurons = std::accumulate(layerSizes.begin(), layerSizes.end(), 0u);
+} // namespace
 
-    // Compute offsets and layer info
-    computeOffsets();
+NeuralBuffers::~NeuralBuffers() {
+    cleanup();
+}
+
+bool NeuralBuffers::initialize(const std::vector<uint32_t>& layerSizes,
+                                const std::vector<uint32_t>& activations) {
+    if (layerSizes.size() < 2) {
+        std::cerr << "[ERROR] Network needs at least an input and an output layer\n";
+        return false;
+    }
 
     // Store activation types
     if (activations.size() != layerSizes.size() - 1) {
         std::cerr << "[ERROR] Activation count mismatch. Expected "
                   << (layerSizes.size() - 1) << ", got " << activations.size() << "\n";
-        return;
+        return false;
     }
 
+    // A plain MLP is a chain of dense layers on a C x 1 x 1 input
+    TensorShape inputShape;
+    inputShape.channels = layerSizes[0];
+
+    std::vector<LayerDesc> layers;
     for (size_t i = 0; i < activations.size(); ++i) {
-        m_layerInfo[i].activationType = activations[i];
+        layers.push_back(LayerDesc::dense(layerSizes[i + 1], activations[i]));
+    }
+    return initialize(inputShape, layers);
+}
+
+bool NeuralBuffers::initialize(const TensorShape& inputShape, const std::vector<LayerDesc>& layers) {
+    cleanup();  // Clean up any existing buffers
+
+    // Verify struct size matches std140 expectations (multiple of 16 bytes, matches the shaders)
+    static_assert(sizeof(LayerInfo) == 80, "LayerInfo must be 80 bytes for std140 alignment");
+
+    if (layers.empty()) {
+        std::cerr << "[ERROR] Network needs at least an input and an output layer\n";
+        return false;
+    }
+
+    if (m_config.topK > MAX_TOP_K) {
+        std::cerr << "[ERROR] topK " << m_config.topK << " exceeds maximum of " << MAX_TOP_K << "\n";
+        return false;
+    }
+
+    // Feature map shapes follow from the input shape and each layer's parameters
+    std::vector<TensorShape> shapes = {inputShape};
+    for (size_t i = 0; i < layers.size(); ++i) {
+        const LayerDesc& desc = layers[i];
+        const TensorShape out = layerOutputShape(shapes.back(), desc);
+        if (out.size() == 0) {
+            std::cerr << "[ERROR] Layer " << i << " produces an empty output "
+                      << "(kernel larger than padded input, or zero units/channels)\n";
+            return false;
+        }
+
+        if (desc.kind != LayerKind::Dense &&
+            desc.activation == static_cast<uint32_t>(Activation::Softmax)) {
+            std::cerr << "[ERROR] Layer " << i << ": softmax is only supported on dense layers\n";
+            return false;
+        }
+        if (m_config.sparseInput && (desc.residualFrom == 0 || (i == 0 && desc.kind != LayerKind::Dense))) {
+            std::cerr << "[ERROR] Layer " << i << ": sparse input needs a dense first layer and no "
+                      << "residual from the input\n";
+            return false;
+        }
+        if (desc.residualFrom >= 0) {
+            // Skip input is an earlier, already computed range of the same size
+            if (static_cast<size_t>(desc.residualFrom) > i ||
+                shapes[desc.residualFrom].size() != out.size()) {
+                std::cerr << "[ERROR] Layer " << i << ": residual source " << desc.residualFrom
+                          << " must be an earlier layer with " << out.size() << " neurons\n";
+                return false;
+            }
+        }
+        if (desc.tiedTo >= 0) {
+            // The source matrix is read in place (as is or transposed), so it must own its weights
+            const size_t source = static_cast<size_t>(desc.tiedTo);
+            if (desc.kind != LayerKind::Dense || source >= i || layers[source].kind != LayerKind::Dense ||
+                layers[source].tiedTo >= 0) {
+                std::cerr << "[ERROR] Layer " << i << ": tied weights need a dense layer and an earlier "
+                          << "dense source layer with its own weights (got " << desc.tiedTo << ")\n";
+                return false;
+            }
+            const uint64_t sourceIn = shapes[source].size();
+            const uint64_t sourceOut = shapes[source + 1].size();
+            const uint64_t expectedIn = desc.tiedTransposed ? out.size() : shapes.back().size();
+            const uint64_t expectedOut = desc.tiedTransposed ? shapes.back().size() : out.size();
+            if (sourceIn != expectedIn || sourceOut != expectedOut) {
+                std::cerr << "[ERROR] Layer " << i << ": tied source layer " << source << " is " << sourceIn
+                          << " -> " << sourceOut << ", expected " << expectedIn << " -> " << expectedOut
+                          << (desc.tiedTransposed ? " (transposed tie)" : "") << "\n";
+                return false;
+            }
+            if (m_config.streamWeights) {
+                std::cerr << "[ERROR] Layer " << i << ": tied weights are not supported with streamWeights\n";
+                return false;
+            }
+        }
+        if (desc.kind == LayerKind::BinaryDense && shapes.back().size() > MAX_BINARY_INPUTS) {
+            std::cerr << "[ERROR] Layer " << i << ": binary layers take at most " << MAX_BINARY_INPUTS
+                      << " inputs, got " << shapes.back().size() << "\n";
+            return false;
+        }
+        if (desc.kind == LayerKind::LowRankDense) {
+            if (desc.rank == 0 || desc.rank > MAX_LOW_RANK) {
+                std::cerr << "[ERROR] Layer " << i << ": low-rank layers need a rank in [1, "
+                          << MAX_LOW_RANK << "], got " << desc.rank << "\n";
+                return false;
+            }
+            if (layerWeightCount(shapes.back(), desc) >= shapes.back().size() * out.size()) {
+                std::cout << "[WARNING] Layer " << i << ": rank " << desc.rank
+                          << " stores no fewer weights than the full " << out.size() << "x"
+                          << shapes.back().size() << " matrix\n";
+            }
+        }
+        if (desc.kind == LayerKind::Conv2D) {
+            const uint32_t patch = (CONV_TILE - 1) * desc.stride + desc.kernelSize;
+            if (patch > CONV_MAX_PATCH) {
+                std::cerr << "[ERROR] Layer " << i << ": kernel " << desc.kernelSize << " with stride "
+                          << desc.stride << " needs a " << patch << "^2 input patch (max "
+                          << CONV_MAX_PATCH << "^2)\n";
+                return false;
+            }
+        }
+        shapes.push_back(out);
+    }
+
+    std::vector<uint32_t> topology;
+    for (const TensorShape& shape : shapes) {
+        if (shape.size() > UINT32_MAX) {
+            std::cerr << "[ERROR] Feature map of " << shape.size() << " neurons exceeds 32-bit indexing\n";
+            return false;
+        }
+        topology.push_back(static_cast<uint32_t>(shape.size()));
+    }
+
+    // Per-layer weight precision, from the policy file if one is configured
+    std::vector<Precision> precisions = m_config.layerPrecision;
+    if (!m_config.precisionPolicyPath.empty() &&
+        !loadPrecisionPolicy(m_config.precisionPolicyPath, precisions)) {
+        return false;
+    }
+    if (precisions.empty()) {
+        precisions.assign(layers.size(), Precision::FP32);
+    }
+    if (precisions.size() != layers.size()) {
+        std::cerr << "[ERROR] Precision count mismatch. Expected " << layers.size()
+                  << ", got " << precisions.size() << "\n";
+        return false;
+    }
+    for (size_t i = 0; i < layers.size(); ++i) {
+        if (precisions[i] != Precision::FP32 && layers[i].kind != LayerKind::Dense) {
+            std::cerr << "[ERROR] Layer " << i << ": " << precisionName(precisions[i])
+                      << " weights are only supported on dense layers\n";
+            return false;
+        }
+        // One stored matrix serves both layers, and only fp32 rows can be read transposed
+        const int32_t source = layers[i].tiedTo;
+        if (source >= 0 && (precisions[i] != Precision::FP32 || precisions[source] != Precision::FP32)) {
+            std::cerr << "[ERROR] Layer " << i << ": tied weights (and their source layer " << source
+                      << ") must stay fp32\n";
+            return false;
+        }
+    }
+
+    m_topology = topology;
+    m_layerShapes = shapes;
+    m_layerDescs = layers;
+    m_layerPrecision = precisions;
+
+    // Shard limit: the driver's SSBO block size, optionally capped by config. Offsets into
+    // a shard are uint32 float indices, so no shard may exceed 2^32 - 1 floats
+    GLint64 maxBlockSize = 0;
+    glGetInteger64v(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &maxBlockSize);
+    m_maxShardBytes = std::min(static_cast<uint64_t>(maxBlockSize), uint64_t{UINT32_MAX} * sizeof(float));
+    if (m_config.maxShardBytes != 0) {
+        m_maxShardBytes = std::min(m_maxShardBytes, m_config.maxShardBytes);
+    }
+
+    // Compute offsets and layer info
+    if (!computeOffsets()) {
+        m_topology.clear();
+        m_layerShapes.clear();
+        m_layerDescs.clear();
+        m_layerPrecision.clear();
+        m_layerInfo.clear();
+        return false;
+    }
+
+    for (size_t i = 0; i < layers.size(); ++i) {
+        m_layerInfo[i].activationType = layers[i].activation;
+    }
+
+    // Folding parameters belong to the previous network
+    m_bnScale.assign(layers.size(), {});
+    m_bnShift.assign(layers.size(), {});
+    m_inputMean.clear();
+    m_inputScale.clear();
+    m_inputBiasShift.clear();
+    m_hostBiases.clear();
+    m_hostWeights.clear();
+    m_weightsUploaded = false;
+    m_dirtyWeights.clear();
+    m_dirtyBiases.clear();
+    m_firstDirtyLayer = 0;
+    m_weightsVersion++;
+
+    if (m_config.topK > 0 && layers.back().activation != static_cast<uint32_t>(Activation::Softmax)) {
+        std::cerr << "[WARNING] topK requires a softmax output layer, fused top-k disabled\n";
     }
 
     // Create GPU buffers
     createBuffers();
 
+    // Fresh storage is undefined; vec4 padding in particular must read as zero
+    clearActivations();
+
     std::cout << "[INFO] Neural buffers initialized:\n";
     std::cout << "  Total neurons: " << m_totalNeurons << "\n";
-    std::cout << "  Total weights: " << m_totalWeights << "\n";
+    std::cout << "  Total weights: " << m_totalWeights
+              << " (" << m_weightShards.size() << " shard(s))\n";
     std::cout << "  Total biases:  " << m_totalBiases << "\n";
+    return true;
 }
 
-void NeuralBuffers::computeOffsets() {
+bool NeuralBuffers::computeOffsets() {
     m_layerInfo.clear();
+    m_layerWeightStart.clear();
+    m_weightShards.clear();
     m_totalWeights = 0;
     m_totalBiases = 0;
+    m_maxLayerWeights = 0;
+
+    // All sizing is done in 64 bits, then checked against what the GPU can address
+    const uint64_t maxShardFloats = m_maxShardBytes / sizeof(float);
+    uint64_t totalNeurons = 0;
+    for (uint32_t size : m_topology) {
+        totalNeurons += size;
+    }
+    // Activation ranges, each starting on a vec4 boundary in padded mode
+    std::vector<uint64_t> activationSizes;
+    for (uint32_t size : m_topology) {
+        activationSizes.push_back(m_config.padToVec4 ? (static_cast<uint64_t>(size) + 3) / 4 * 4 : size);
+    }
+    uint64_t activationBufferSize = 0;
+    std::vector<uint64_t> activationOffsets;
+    if (m_config.reuseActivations) {
+        activationBufferSize = planActivationArena(activationSizes, activationOffsets);
+        std::cout << "[INFO] Activation arena: " << activationBufferSize << " floats (all layers resident: "
+                  << std::accumulate(activationSizes.begin(), activationSizes.end(), uint64_t{0}) << ")\n";
+    } else {
+        for (uint64_t size : activationSizes) {
+            activationOffsets.push_back(activationBufferSize);
+            activationBufferSize += size;
+        }
+    }
 
-    uint32_t activationOffset = 0;  // Track position in activations buffer
+    if (activationBufferSize > UINT32_MAX || activationBufferSize > maxShardFloats) {
+        std::cerr << "[ERROR] Activation buffer too large: " << activationBufferSize
+                  << " floats (limit " << std::min<uint64_t>(UINT32_MAX, maxShardFloats) << ")\n";
+        return false;
+    }
+    m_totalNeurons = static_cast<uint32_t>(totalNeurons);
+    m_activationBufferSize = static_cast<uint32_t>(activationBufferSize);
+    m_activationOffsets.assign(activationOffsets.begin(), activationOffsets.end());
 
     for (size_t i = 0; i < m_topology.size() - 1; ++i) {
-        LayerInfo info;
+        const LayerDesc& desc = m_layerDescs[i];
+        const TensorShape& in = m_layerShapes[i];
+        const TensorShape& out = m_layerShapes[i + 1];
+
+        LayerInfo info{};
         info.inputSize = m_topology[i];
         info.outputSize = m_topology[i + 1];
-        info.weightOffset = m_totalWeights;
-        info.biasOffset = m_totalBiases;
+        info.biasOffset = static_cast<uint32_t>(m_totalBiases);
         info.activationType = 0;  // Will be set later
 
+        info.layerKind = static_cast<uint32_t>(desc.kind);
+        info.inputChannels = in.channels;
+        info.inputHeight = in.height;
+        info.inputWidth = in.width;
+        info.outputChannels = out.channels;
+        info.outputHeight = out.height;
+        info.outputWidth = out.width;
+        if (!desc.isDense()) {
+            info.kernelSize = desc.kernelSize;
+            info.stride = desc.stride;
+            info.padding = desc.padding;
+        } else if (desc.kind == LayerKind::LowRankDense) {
+            info.kernelSize = desc.rank;
+        }
+        info.weightPrecision = static_cast<uint32_t>(m_layerPrecision[i]);
+
+        // Flat (canonical) count vs. what the storage layout occupies on the GPU
+        const uint64_t layerWeights = layerWeightCount(in, desc);
+        const uint64_t layerStorage = desc.tiedTo >= 0 ? 0 : layerStorageSize(info);
+        if (layerStorage > maxShardFloats) {
+            std::cerr << "[ERROR] Layer " << i << " has " << layerStorage
+                      << " weights, more than one SSBO can hold (" << maxShardFloats << ")\n";
+            return false;
+        }
+
+        if (desc.tiedTo >= 0) {
+            // Tied layers read their source's storage; a transposed tie walks it with the
+            // source's row stride (kept in the otherwise unused dense stride field)
+            const LayerInfo& source = m_layerInfo[desc.tiedTo];
+            info.weightShard = source.weightShard;
+            info.weightOffset = source.weightOffset;
+            info.stride = desc.tiedTransposed ? inputStride(source) : 0;
+        } else if (layerStorage == 0) {
+            // Weight-less layers (pooling) take no shard space and bind no weights
+            info.weightShard = m_weightShards.empty() ? 0 : static_cast<uint32_t>(m_weightShards.size() - 1);
+            info.weightOffset = 0;
+        } else {
+            // Open a new shard when this layer does not fit in the current one.
+            // Streaming mode uses one "shard" per layer: each slot holds a single layer.
+            if (m_weightShards.empty() || m_config.streamWeights ||
+                m_weightShards.back().size + layerStorage > maxShardFloats) {
+                WeightShard shard;
+                shard.globalOffset = m_totalWeights;
+                m_weightShards.push_back(shard);
+            }
+            WeightShard& shard = m_weightShards.back();
+
+            info.weightShard = static_cast<uint32_t>(m_weightShards.size() - 1);
+            info.weightOffset = static_cast<uint32_t>(shard.size);
+            shard.size += layerStorage;
+        }
+
         // Calculate activation buffer offsets
-        info.inputOffset = activationOffset;
-        info.outputOffset = activationOffset + info.inputSize;
+        info.inputOffset = m_activationOffsets[i];
+        info.outputOffset = m_activationOffsets[i + 1];
 
-        // Initialize padding
-        info._padding[0] = 0;
+        // Residual adds read the skip range in place - no copy, no extra pass
+        info.residualOffset = desc.residualFrom >= 0 ? m_activationOffsets[desc.residualFrom] : NO_RESIDUAL;
 
         m_layerInfo.push_back(info);
+        m_layerWeightStart.push_back(m_totalWeights);
 
         // Debug: Print layer info
         std::cout << "  Layer " << i << ": "
                   << "in=" << info.inputSize << " out=" << info.outputSize
                   << " | inputOff=" << info.inputOffset
-                  << " outputOff=" << info.outputOffset << "\n";
+                  << " outputOff=" << info.outputOffset
+                  << " | shard=" << info.weightShard
+                  << " weightOff=" << info.weightOffset;
+        if (desc.tiedTo >= 0) {
+            std::cout << " tied to " << desc.tiedTo << (desc.tiedTransposed ? " (transposed)" : "");
+        }
+        if (m_layerPrecision[i] != Precision::FP32) {
+            std::cout << " " << precisionName(m_layerPrecision[i]);
+        }
+        std::cout << "\n";
+
+        // Weights: inputSize * outputSize (dense) or outC * inC * k * k (conv)
+        m_totalWeights += layerWeights;
+        m_maxLayerWeights = std::max(m_maxLayerWeights, layerStorage);
+
+        // Biases: one per output neuron (dense) or per output channel (conv)
+        m_totalBiases += layerBiasCount(desc);
+    }
+
+    // Bias offsets are uint32 and all biases live in one SSBO
+    if (m_totalBiases > UINT32_MAX || m_totalBiases > maxShardFloats) {
+        std::cerr << "[ERROR] Too many biases: " << m_totalBiases
+                  << " (limit " << std::min<uint64_t>(UINT32_MAX, maxShardFloats) << ")\n";
+        return false;
+    }
+
+    return true;
+}
+
+uint32_t NeuralBuffers::inputStride(const LayerInfo& info) const {
+    // Tiled4 always works on whole tiles of 4 inputs; padded mode pads every layout
+    if (m_config.padToVec4 || m_config.weightLayout == WeightLayout::Tiled4) {
+        return (info.inputSize + 3) / 4 * 4;
+    }
+    return info.inputSize;
+}
+
+uint64_t NeuralBuffers::layerStorageSize(const LayerInfo& info) const {
+    // Storage layouts and vec4 padding apply to dense layers only
+    if (info.layerKind == static_cast<uint32_t>(LayerKind::Conv2D)) {
+        // Padded mode rounds up to whole vec4s so the following dense layers stay aligned
+        const uint64_t count = convWeightCount(info);
+        return m_config.padToVec4 ? (count + 3) / 4 * 4 : count;
+    }
+    if (info.layerKind == static_cast<uint32_t>(LayerKind::BinaryDense)) {
+        // Per row: alpha, then one sign bit per input; vec4 aligned like reduced precisions
+        const uint64_t words = (1 + (static_cast<uint64_t>(info.inputSize) + 31) / 32) * info.outputSize;
+        return (words + 3) / 4 * 4;
+    }
+    if (info.layerKind == static_cast<uint32_t>(LayerKind::LowRankDense)) {
+        // V^T then U^T, vec4 aligned like reduced precisions
+        const uint64_t count = static_cast<uint64_t>(info.kernelSize) * (info.inputSize + info.outputSize);
+        return (count + 3) / 4 * 4;
+    }
+    if (info.layerKind != static_cast<uint32_t>(LayerKind::Dense)) {
+        return 0;
+    }
+    if (info.weightPrecision != static_cast<uint32_t>(Precision::FP32)) {
+        // Packed rows, rounded up to whole vec4s so later layers keep their alignment
+        const uint64_t words = reducedRowWords(info.weightPrecision, info.inputSize) * info.outputSize;
+        return (words + 3) / 4 * 4;
+    }
+    return static_cast<uint64_t>(inputStride(info)) * info.outputSize;
+}
+
+uint64_t NeuralBuffers::getLayerWeightCount(size_t layerIndex) const {
+    return layerWeightCount(m_layerShapes[layerIndex], m_layerDescs[layerIndex]);
+}
+
+void NeuralBuffers::packLayerWeights(const LayerInfo& info, const float* rowMajor, float* storage) const {
+    if (info.layerKind == static_cast<uint32_t>(LayerKind::BinaryDense)) {
+        packBinaryWeights(info, rowMajor, storage);
+        return;
+    }
+    if (info.layerKind == static_cast<uint32_t>(LayerKind::LowRankDense)) {
+        packLowRankWeights(info, rowMajor, storage);
+        return;
+    }
+    if (info.layerKind != static_cast<uint32_t>(LayerKind::Dense)) {
+        const uint64_t count = convWeightCount(info);
+        std::memcpy(storage, rowMajor, count * sizeof(float));
+        std::fill(storage + count, storage + layerStorageSize(info), 0.0f);
+        return;
+    }
+    if (info.weightPrecision != static_cast<uint32_t>(Precision::FP32)) {
+        packReducedPrecision(info, rowMajor, storage);
+        return;
+    }
+
+    const uint64_t in = info.inputSize;
+    const uint64_t out = info.outputSize;
+    const uint64_t stride = inputStride(info);   // >= in; extra inputs are zero padding
+
+    switch (m_config.weightLayout) {
+        case WeightLayout::InputMajor:
+            for (uint64_t i = 0; i < stride; ++i) {
+                for (uint64_t o = 0; o < out; ++o) {
+                    storage[i * out + o] = i < in ? rowMajor[o * in + i] : 0.0f;
+                }
+            }
+            break;
+        case WeightLayout::Tiled4: {
+            const uint64_t tiles = stride / 4;
+            for (uint64_t t = 0; t < tiles; ++t) {
+                for (uint64_t o = 0; o < out; ++o) {
+                    for (uint64_t k = 0; k < 4; ++k) {
+                        const uint64_t i = t * 4 + k;
+                        storage[(t * out + o) * 4 + k] = i < in ? rowMajor[o * in + i] : 0.0f;
+                    }
+                }
+            }
+            break;
+        }
+        case WeightLayout::RowMajor:
+        default:
+            if (stride == in) {
+                std::memcpy(storage, rowMajor, in * out * sizeof(float));
+                break;
+            }
+            for (uint64_t o = 0; o < out; ++o) {
+                std::memcpy(storage + o * stride, rowMajor + o * in, in * sizeof(float));
+                std::fill(storage + o * stride + in, storage + (o + 1) * stride, 0.0f);
+            }
+            break;
+    }
+}
+
+void NeuralBuffers::unpackLayerWeights(const LayerInfo& info, const float* storage, float* rowMajor) const {
+    if (info.layerKind == static_cast<uint32_t>(LayerKind::BinaryDense)) {
+        unpackBinaryWeights(info, storage, rowMajor);
+        return;
+    }
+    if (info.layerKind == static_cast<uint32_t>(LayerKind::LowRankDense)) {
+        unpackLowRankWeights(info, storage, rowMajor);
+        return;
+    }
+    if (info.layerKind != static_cast<uint32_t>(LayerKind::Dense)) {
+        std::memcpy(rowMajor, storage, convWeightCount(info) * sizeof(float));
+        return;
+    }
+    if (info.weightPrecision != static_cast<uint32_t>(Precision::FP32)) {
+        unpackReducedPrecision(info, storage, rowMajor);
+        return;
+    }
 
-        // Move offset forward by the number of neurons in this layer's input
-        activationOffset += m_topology[i];
+    const uint64_t in = info.inputSize;
+    const uint64_t out = info.outputSize;
+    const uint64_t stride = inputStride(info);
 
-        // Weights: inputSize * outputSize
-        m_totalWeights += info.inputSize * info.outputSize;
+    switch (m_config.weightLayout) {
+        case WeightLayout::InputMajor:
+            for (uint64_t o = 0; o < out; ++o) {
+                for (uint64_t i = 0; i < in; ++i) {
+                    rowMajor[o * in + i] = storage[i * out + o];
+                }
+            }
+            break;
+        case WeightLayout::Tiled4:
+            for (uint64_t o = 0; o < out; ++o) {
+                for (uint64_t i = 0; i < in; ++i) {
+                    rowMajor[o * in + i] = storage[((i / 4) * out + o) * 4 + (i % 4)];
+                }
+            }
+            break;
+        case WeightLayout::RowMajor:
+        default:
+            for (uint64_t o = 0; o < out; ++o) {
+                std::memcpy(rowMajor + o * in, storage + o * stride, in * sizeof(float));
+            }
+            break;
+    }
+}
+
+void NeuralBuffers::packReducedPrecision(const LayerInfo& info, const float* rowMajor, float* storage) const {
+    const uint64_t in = info.inputSize;
+    const uint64_t rowWords = reducedRowWords(info.weightPrecision, in);
+    std::vector<uint32_t> words(layerStorageSize(info), 0u);
+
+    for (uint64_t o = 0; o < info.outputSize; ++o) {
+        const float* row = rowMajor + o * in;
+        uint32_t* packed = words.data() + o * rowWords;
+
+        if (info.weightPrecision == static_cast<uint32_t>(Precision::FP16)) {
+            // Input i is half (i & 1) of word i / 2, low half first (unpackHalf2x16)
+            for (uint64_t i = 0; i < in; ++i) {
+                packed[i / 2] |= static_cast<uint32_t>(floatToHalf(row[i])) << (16 * (i % 2));
+            }
+            continue;
+        }
+
+        // INT8: w ~= scale * q / 127, q in [-127, 127] (unpackSnorm4x8 clamps -128 anyway)
+        float scale = 0.0f;
+        for (uint64_t i = 0; i < in; ++i) {
+            scale = std::max(scale, std::fabs(row[i]));
+        }
+        std::memcpy(&packed[0], &scale, sizeof(scale));
+        for (uint64_t i = 0; i < in && scale > 0.0f; ++i) {
+            const long q = std::clamp(std::lround(row[i] / scale * 127.0f), -127L, 127L);
+            packed[1 + i / 4] |= (static_cast<uint32_t>(q) & 0xFFu) << (8 * (i % 4));
+        }
+    }
+    std::memcpy(storage, words.data(), words.size() * sizeof(uint32_t));
+}
+
+void NeuralBuffers::unpackReducedPrecision(const LayerInfo& info, const float* storage, float* rowMajor) const {
+    const uint64_t in = info.inputSize;
+    const uint64_t rowWords = reducedRowWords(info.weightPrecision, in);
+
+    for (uint64_t o = 0; o < info.outputSize; ++o) {
+        std::vector<uint32_t> packed(rowWords);
+        std::memcpy(packed.data(), storage + o * rowWords, rowWords * sizeof(uint32_t));
+        float* row = rowMajor + o * in;
+
+        if (info.weightPrecision == static_cast<uint32_t>(Precision::FP16)) {
+            for (uint64_t i = 0; i < in; ++i) {
+                row[i] = halfToFloat(static_cast<uint16_t>(packed[i / 2] >> (16 * (i % 2))));
+            }
+            continue;
+        }
+
+        float scale;
+        std::memcpy(&scale, &packed[0], sizeof(scale));
+        for (uint64_t i = 0; i < in; ++i) {
+            const int8_t q = static_cast<int8_t>((packed[1 + i / 4] >> (8 * (i % 4))) & 0xFFu);
+            row[i] = scale * static_cast<float>(q) / 127.0f;
+        }
+    }
+}
+
+void NeuralBuffers::packBinaryWeights(const LayerInfo& info, const float* rowMajor, float* storage) const {
+    const uint64_t in = info.inputSize;
+    const uint64_t rowWords = 1 + (in + 31) / 32;
+    std::vector<uint32_t> words(layerStorageSize(info), 0u);
+
+    for (uint64_t o = 0; o < info.outputSize; ++o) {
+        const float* row = rowMajor + o * in;
+        uint32_t* packed = words.data() + o * rowWords;
+
+        // alpha = mean |w| minimizes ||w - alpha * sign(w)||; bit set = +1 (w > 0)
+        float alpha = 0.0f;
+        for (uint64_t i = 0; i < in; ++i) {
+            alpha += std::fabs(row[i]);
+            if (row[i] > 0.0f) {
+                packed[1 + i / 32] |= 1u << (i % 32);
+            }
+        }
+        alpha /= static_cast<float>(std::max<uint64_t>(in, 1));
+        std::memcpy(&packed[0], &alpha, sizeof(alpha));
+    }
+    std::memcpy(storage, words.data(), words.size() * sizeof(uint32_t));
+}
+
+void NeuralBuffers::unpackBinaryWeights(const LayerInfo& info, const float* storage, float* rowMajor) const {
+    const uint64_t in = info.inputSize;
+    const uint64_t rowWords = 1 + (in + 31) / 32;
+
+    for (uint64_t o = 0; o < info.outputSize; ++o) {
+        std::vector<uint32_t> packed(rowWords);
+        std::memcpy(packed.data(), storage + o * rowWords, rowWords * sizeof(uint32_t));
+        float alpha;
+        std::memcpy(&alpha, &packed[0], sizeof(alpha));
+        for (uint64_t i = 0; i < in; ++i) {
+            rowMajor[o * in + i] = (packed[1 + i / 32] >> (i % 32)) & 1u ? alpha : -alpha;
+        }
+    }
+}
+
+void NeuralBuffers::packLowRankWeights(const LayerInfo& info, const float* canonical, float* storage) const {
+    // Canonical U [out][r], V [r][in] -> storage V^T [in][r], U^T [r][out]: in both GEMVs
+    // neighbouring threads (bottleneck units, then outputs) read neighbouring floats
+    const uint64_t in = info.inputSize;
+    const uint64_t out = info.outputSize;
+    const uint64_t rank = info.kernelSize;
+    const float* u = canonical;
+    const float* v = canonical + out * rank;
+    float* vt = storage;
+    float* ut = storage + in * rank;
+
+    for (uint64_t k = 0; k < rank; ++k) {
+        for (uint64_t i = 0; i < in; ++i) {
+            vt[i * rank + k] = v[k * in + i];
+        }
+        for (uint64_t o = 0; o < out; ++o) {
+            ut[k * out + o] = u[o * rank + k];
+        }
+    }
+    std::fill(ut + rank * out, storage + layerStorageSize(info), 0.0f);
+}
+
+void NeuralBuffers::unpackLowRankWeights(const LayerInfo& info, const float* storage, float* canonical) const {
+    const uint64_t in = info.inputSize;
+    const uint64_t out = info.outputSize;
+    const uint64_t rank = info.kernelSize;
+    float* u = canonical;
+    float* v = canonical + out * rank;
+    const float* vt = storage;
+    const float* ut = storage + in * rank;
 
-        // Biases: outputSize
-        m_totalBiases += info.outputSize;
+    for (uint64_t k = 0; k < rank; ++k) {
+        for (uint64_t i = 0; i < in; ++i) {
+            v[k * in + i] = vt[i * rank + k];
+        }
+        for (uint64_t o = 0; o < out; ++o) {
+            u[o * rank + k] = ut[k * out + o];
+        }
     }
 }
 
+uint64_t NeuralBuffers::planActivationArena(const std::vector<uint64_t>& sizes,
+                                            std::vector<uint64_t>& offsets) const {
+    // Liveness in forward() steps: topology layer j is written by step j - 1 (the input by
+    // setInputs) and read by step j, plus any later step that uses it as a residual source.
+    // The output layer stays live until readOutputs().
+    const size_t count = sizes.size();
+    std::vector<size_t> lastUse(count);
+    for (size_t j = 0; j < count; ++j) {
+        lastUse[j] = j;
+    }
+    for (size_t step = 0; step < m_layerDescs.size(); ++step) {
+        const int32_t source = m_layerDescs[step].residualFrom;
+        if (source >= 0) {
+            lastUse[source] = std::max(lastUse[source], step);
+        }
+    }
+
+    // Chain layers (live for one step) ping-pong between the two ends of the arena:
+    // even layers start at 0, odd layers end at the arena end, so layers j and j + 1
+    // never overlap as long as the arena holds the larger adjacent pair.
+    auto isChain = [&](size_t j) { return lastUse[j] == j || j + 1 == count; };
+    uint64_t pingPong = 0;
+    for (size_t j = 0; j < count; ++j) {
+        if (!isChain(j)) continue;
+        const uint64_t next = j + 1 < count && isChain(j + 1) ? sizes[j + 1] : 0;
+        pingPong = std::max(pingPong, sizes[j] + next);
+    }
+
+    offsets.assign(count, 0);
+    for (size_t j = 0; j < count; ++j) {
+        if (isChain(j)) {
+            offsets[j] = j % 2 == 0 ? 0 : pingPong - sizes[j];
+        }
+    }
+
+    // Residual sources: first fit after the ping-pong region, sharing space with sources
+    // whose live ranges [j - 1, lastUse] do not overlap
+    uint64_t arenaSize = pingPong;
+    std::vector<size_t> placed;
+    for (size_t j = 0; j < count; ++j) {
+        if (isChain(j)) continue;
+
+        uint64_t offset = pingPong;
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            for (size_t p : placed) {
+                const bool overlapsInTime = p <= lastUse[j] + 1 && j <= lastUse[p] + 1;
+                const bool overlapsInSpace = offset < offsets[p] + sizes[p] && offsets[p] < offset + sizes[j];
+                if (overlapsInTime && overlapsInSpace) {
+                    offset = offsets[p] + sizes[p];
+                    moved = true;
+                }
+            }
+        }
+        offsets[j] = offset;
+        placed.push_back(j);
+        arenaSize = std::max(arenaSize, offset + sizes[j]);
+    }
+    return arenaSize;
+}
+
 void NeuralBuffers::createBuffers() {
-    // Weights SSBO
-    glGenBuffers(1, &m_weightsSSBO);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_weightsSSBO);
-    glBufferData(GL_SHADER_STORAGE_BUFFER,
-                 m_totalWeights * sizeof(float),
-                 nullptr,
-                 GL_DYNAMIC_DRAW);
-
-    // Biases SSBO
-    glGenBuffers(1, &m_biasesSSBO);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_biasesSSBO);
-    glBufferData(GL_SHADER_STORAGE_BUFFER,
-                 m_totalBiases * sizeof(float),
-                 nullptr,
-                 GL_DYNAMIC_DRAW);
-
-    // Activations SSBO
-    glGenBuffers(1, &m_activationsSSBO);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_activationsSSBO);
-    glBufferData(GL_SHADER_STORAGE_BUFFER,
-                 m_totalNeurons * sizeof(float),
-                 nullptr,
-                 GL_DYNAMIC_DRAW);
+    if (m_config.streamWeights) {
+        createStreamingBuffers();
+    } else {
+        for (auto& shard : m_weightShards) {
+            shard.buffer = createBuffer(static_cast<GLsizeiptr>(shard.size * sizeof(float)), &shard.mapped);
+        }
+    }
+    m_biasesSSBO = createBuffer(m_totalBiases * sizeof(float), &m_biasesMapped);
+    m_activationsSSBO = createBuffer(m_activationBufferSize * sizeof(float), &m_activationsMapped);
 
+    // Written by the GPU, read by the host: no upload strategy applies
+    const uint32_t topK = std::min(m_config.topK, m_topology.back());
+    if (topK > 0 && m_layerInfo.back().activationType == static_cast<uint32_t>(Activation::Softmax)) {
+        glGenBuffers(1, &m_topKSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_topKSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, topK * sizeof(TopKEntry), nullptr, GL_DYNAMIC_READ);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // Sparse input updates need z = Wx + b of a plain fp32 dense first layer, and the input
+    // range must survive the pass (not the case with reuseActivations)
+    const LayerDesc& first = m_layerDescs[0];
+    if (first.kind == LayerKind::Dense && first.residualFrom < 0 && !m_config.sparseInput &&
+        first.activation != static_cast<uint32_t>(Activation::Softmax) && !m_config.reuseActivations &&
+        m_layerPrecision[0] == Precision::FP32) {
+        glGenBuffers(1, &m_preActivationSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_preActivationSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_topology[1] * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        m_inputDeltaSSBO = createBuffer(MAX_INPUT_DELTAS * sizeof(InputDelta), &m_inputDeltaMapped);
+    }
+
+    if (m_config.sparseInput) {
+        m_sparseInputSSBO = createBuffer(std::max(1u, m_config.maxActiveInputs) * sizeof(SparseInput),
+                                         &m_sparseInputMapped);
+        m_sparseInputCount = 0;
+        m_sparseInputActive = true;
+    }
+}
+
+void NeuralBuffers::createStreamingBuffers() {
+    const GLsizeiptr slotBytes = static_cast<GLsizeiptr>(m_maxLayerWeights) * sizeof(float);
+    const uint32_t window = std::max(2u, m_config.streamingWindow);
+
+    // Resident slots, each large enough for the biggest layer
+    m_weightSlots.assign(window, WeightSlot{});
+    for (auto& slot : m_weightSlots) {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, slot.buffer);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, slotBytes, nullptr, 0);
+    }
+
+    // Two persistently mapped staging buffers so one can be filled while the other is copied
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    for (int i = 0; i < 2; ++i) {
+        glGenBuffers(1, &m_stagingBuffers[i]);
+        glBindBuffer(GL_COPY_READ_BUFFER, m_stagingBuffers[i]);
+        glBufferStorage(GL_COPY_READ_BUFFER, slotBytes, nullptr, flags);
+        m_stagingMapped[i] = glMapBufferRange(GL_COPY_READ_BUFFER, 0, slotBytes, flags);
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    std::cout << "[INFO] Weight streaming enabled: " << window << " slots of "
+              << slotBytes << " bytes (total weights " << m_totalWeights * sizeof(float) << " bytes)\n";
 }
 
-void NeuralBuffers::uploadWeights(const std::vector<float>& weights) {
+GLuint NeuralBuffers::createBuffer(GLsizeiptr size, void** mappedOut) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+
+    *mappedOut = nullptr;
+
+    if (m_config.uploadStrategy == UploadStrategy::PersistentMap) {
+        // Immutable storage, mapped once for the lifetime of the buffer
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, size, nullptr, flags | GL_DYNAMIC_STORAGE_BIT);
+        *mappedOut = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, flags);
+        if (!*mappedOut) {
+            std::cerr << "[ERROR] Persistent mapping failed, falling back to glBufferSubData\n";
+        }
+    } else {
+        glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return buffer;
+}
+
+void NeuralBuffers::uploadRange(GLuint buffer, void* mapped, GLsizeiptr bufferSize,
+                                 GLintptr offset, GLsizeiptr size, const void* data) {
+    if (size == 0) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+
+    switch (m_config.uploadStrategy) {
+        case UploadStrategy::MapRange: {
+            void* dst = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, offset, size,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+            if (dst) {
+                std::memcpy(dst, data, size);
+                glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+            } else {
+                glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+            }
+            break;
+        }
+        case UploadStrategy::Orphan:
+            // Orphaning discards the whole store, so only whole-buffer writes qualify
+            if (offset == 0 && size == bufferSize) {
+                glBufferData(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_DYNAMIC_DRAW);
+            }
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+            break;
+        case UploadStrategy::PersistentMap:
+            if (mapped) {
+                // Wait for in-flight commands that may read this range. One copy per buffer,
+                // so this drains the whole queue on every upload (synchronous baseline)
+                GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+                }
+                glDeleteSync(fence);
+
+                std::memcpy(static_cast<char*>(mapped) + offset, data, size);
+            } else {
+                glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+            }
+            break;
+        case UploadStrategy::SubData:
+        default:
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+            break;
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+bool NeuralBuffers::uploadWeights(const std::vector<float>& weights) {
     if (weights.size() != m_totalWeights) {
         std::cerr << "[ERROR] Weight count mismatch. Expected "
                   << m_totalWeights << ", got " << weights.size() << "\n";
+        return false;
+    }
+
+    return uploadWeights(weights.data(), weights.size());
+}
+
+bool NeuralBuffers::uploadWeights(const float* weights, size_t count, size_t offset) {
+    if (m_config.streamWeights) {
+        std::cerr << "[ERROR] Weights are streamed in this mode, use setStreamingSource()\n";
+        return false;
+    }
+    if (offset > m_totalWeights || count > m_totalWeights - offset) {
+        std::cerr << "[ERROR] Weight range out of bounds. Offset " << offset
+                  << " + count " << count << " > " << m_totalWeights << "\n";
+        return false;
+    }
+
+    // Repacked or folded storage is rebuilt per layer, so reject a partial layer before
+    // the shadow, version or dirty state change
+    if ((hasRepackedStorage() || hasFolding()) && !coversWholeLayers(offset, count)) {
+        std::cerr << "[ERROR] Weight range must cover whole layers with a padded, non-row-major, "
+                  << "reduced-precision, low-rank or folded layout\n";
+        return false;
+    }
+
+    // The setWeight() shadow only exists once a weight was edited; keep it current
+    if (!m_hostWeights.empty()) {
+        std::copy(weights, weights + count, m_hostWeights.begin() + offset);
+    }
+    m_weightsUploaded = true;
+    m_weightsVersion++;
+    uploadWeightStorage(offset, count, weights);
+    return true;
+}
+
+bool NeuralBuffers::coversWholeLayers(uint64_t offset, uint64_t count) const {
+    const uint64_t end = offset + count;
+    for (size_t layer = 0; layer < m_layerInfo.size(); ++layer) {
+        const uint64_t first = m_layerWeightStart[layer];
+        const uint64_t last = first + getLayerWeightCount(layer);
+        if (first < last && first < end && last > offset && (first < offset || last > end)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NeuralBuffers::uploadWeightStorage(uint64_t offset, uint64_t count, const float* weights) {
+    const uint64_t end = offset + count;
+
+    for (size_t layer = 0; layer < m_layerInfo.size(); ++layer) {
+        const uint64_t first = m_layerWeightStart[layer];
+        if (first < end && first + getLayerWeightCount(layer) > offset) {
+            markLayerDirty(layer);
+            break;
+        }
+    }
+
+    if (hasRepackedStorage() || hasFolding()) {
+        // Fold and convert whole layers into the storage layout, one upload per layer
+        // (uploadWeights() and flushDirtyRanges() only pass whole-layer ranges here)
+        std::vector<float> packed;
+        bool foldedInput = false;
+        for (size_t layer = 0; layer < m_layerInfo.size(); ++layer) {
+            const LayerInfo& info = m_layerInfo[layer];
+            const uint64_t first = m_layerWeightStart[layer];
+            const uint64_t last = first + getLayerWeightCount(layer);
+            if (first == last || last <= offset || first >= end) continue;
+
+            const auto& shard = m_weightShards[info.weightShard];
+            packed.resize(layerStorageSize(info));
+            packLayerWeights(info, foldLayerWeights(layer, weights + (first - offset)), packed.data());
+            uploadRange(shard.buffer, shard.mapped, static_cast<GLsizeiptr>(shard.size * sizeof(float)),
+                        static_cast<GLintptr>(info.weightOffset) * sizeof(float),
+                        static_cast<GLsizeiptr>(packed.size() * sizeof(float)), packed.data());
+            foldedInput = foldedInput || (layer == 0 && !m_inputScale.empty());
+        }
+
+        // The input normalization bias shift depends on the first layer's weights
+        if (foldedInput) {
+            uploadFoldedBiases();
+        }
         return;
     }
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_weightsSSBO);
-    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
-                    weights.size() * sizeof(float),
-                    weights.data());
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    // Split the flat range across the shards it touches
+    for (auto& shard : m_weightShards) {
+        const uint64_t shardEnd = shard.globalOffset + shard.size;
+        const uint64_t first = std::max<uint64_t>(offset, shard.globalOffset);
+        const uint64_t last = std::min<uint64_t>(end, shardEnd);
+        if (first >= last) continue;
+
+        uploadRange(shard.buffer, shard.mapped, static_cast<GLsizeiptr>(shard.size * sizeof(float)),
+                    static_cast<GLintptr>((first - shard.globalOffset) * sizeof(float)),
+                    static_cast<GLsizeiptr>((last - first) * sizeof(float)),
+                    weights + (first - offset));
+    }
+}
+
+void NeuralBuffers::setStreamingSource(const float* weights, size_t count) {
+    if (!m_config.streamWeights) {
+        std::cerr << "[ERROR] setStreamingSource() requires Config::streamWeights\n";
+        return;
+    }
+    if (count != m_totalWeights) {
+        std::cerr << "[ERROR] Streaming source size mismatch. Expected "
+                  << m_totalWeights << ", got " << count << "\n";
+        return;
+    }
+
+    m_streamingSource = weights;
+    markLayerDirty(0);
+    m_weightsVersion++;
+
+    // Anything resident came from the previous source
+    for (auto& slot : m_weightSlots) {
+        slot.layer = -1;
+    }
+
+    // Recompute the input normalization bias shift from the new first layer
+    if (!m_inputScale.empty()) {
+        foldLayerWeights(0, m_streamingSource);
+        uploadFoldedBiases();
+    }
+}
+
+void NeuralBuffers::bindLayerWeights(size_t layerIndex, GLuint binding) {
+    if (!m_layerDescs[layerIndex].hasWeights()) {
+        return;     // Pooling layers read no weights
+    }
+
+    if (!m_config.streamWeights) {
+        const auto& shard = m_weightShards[m_layerInfo[layerIndex].weightShard];
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, shard.buffer);
+        return;
+    }
+
+    int slot = findResidentSlot(layerIndex);
+    if (slot < 0) {
+        slot = stageLayer(layerIndex);
+    }
+    if (slot < 0) {
+        return;
+    }
+
+    m_weightSlots[slot].lastUse = ++m_slotUseCounter;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_weightSlots[slot].buffer);
+}
+
+void NeuralBuffers::prefetchLayer(size_t layerIndex) {
+    if (!m_config.streamWeights || layerIndex >= m_layerInfo.size()) return;
+    if (getLayerWeightCount(layerIndex) == 0) return;
+
+    if (findResidentSlot(layerIndex) < 0) {
+        stageLayer(layerIndex);
+    }
+}
+
+int NeuralBuffers::findResidentSlot(size_t layerIndex) const {
+    for (size_t i = 0; i < m_weightSlots.size(); ++i) {
+        if (m_weightSlots[i].layer == static_cast<int64_t>(layerIndex)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int NeuralBuffers::stageLayer(size_t layerIndex) {
+    if (!m_streamingSource) {
+        std::cerr << "[ERROR] No streaming source set for layer " << layerIndex << "\n";
+        return -1;
+    }
+
+    // Recycle the least recently used slot; the most recently bound layer is never evicted
+    int slot = 0;
+    for (size_t i = 1; i < m_weightSlots.size(); ++i) {
+        if (m_weightSlots[i].lastUse < m_weightSlots[slot].lastUse) {
+            slot = static_cast<int>(i);
+        }
+    }
+
+    const LayerInfo& info = m_layerInfo[layerIndex];
+    const GLsizeiptr bytes = static_cast<GLsizeiptr>(layerStorageSize(info) * sizeof(float));
+
+    // Wait until the GPU has finished copying out of this staging buffer last time
+    const uint32_t staging = m_nextStaging;
+    m_nextStaging = (m_nextStaging + 1) % 2;
+    if (m_stagingFences[staging]) {
+        while (glClientWaitSync(m_stagingFences[staging], GL_SYNC_FLUSH_COMMANDS_BIT,
+                                1000000) == GL_TIMEOUT_EXPIRED) {
+        }
+        glDeleteSync(m_stagingFences[staging]);
+        m_stagingFences[staging] = nullptr;
+    }
+
+    if (!m_stagingMapped[staging]) {
+        std::cerr << "[ERROR] Streaming staging buffer is not mapped\n";
+        return -1;
+    }
+
+    // Host copy (pages in from the mapped file) - overlaps with queued GPU work
+    packLayerWeights(info, foldLayerWeights(layerIndex, m_streamingSource + m_layerWeightStart[layerIndex]),
+                     static_cast<float*>(m_stagingMapped[staging]));
+
+    // GPU copy is ordered after previously issued dispatches that read the slot
+    glBindBuffer(GL_COPY_READ_BUFFER, m_stagingBuffers[staging]);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_weightSlots[slot].buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    m_stagingFences[staging] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_weightSlots[slot].layer = static_cast<int64_t>(layerIndex);
+    m_weightSlots[slot].lastUse = ++m_slotUseCounter;
+    return slot;
+}
+
+bool NeuralBuffers::setWeight(size_t layerIndex, uint32_t outputIndex, uint32_t inputIndex, float value) {
+    if (layerIndex >= m_layerDescs.size()) {
+        std::cerr << "[ERROR] Layer index out of bounds: " << layerIndex << "\n";
+        return false;
+    }
+
+    if (m_layerDescs[layerIndex].kind == LayerKind::LowRankDense) {
+        std::cerr << "[ERROR] Layer " << layerIndex << " is low-rank and has no per-connection weights, "
+                  << "edit its factors with setWeightRange()\n";
+        return false;
+    }
+    if (m_layerDescs[layerIndex].tiedTo >= 0) {
+        std::cerr << "[ERROR] Layer " << layerIndex << " shares the weights of layer "
+                  << m_layerDescs[layerIndex].tiedTo << ", edit them there\n";
+        return false;
+    }
+
+    // One row per output neuron (conv: per output channel)
+    const uint64_t rows = layerBiasCount(m_layerDescs[layerIndex]);
+    const uint64_t rowLength = rows > 0 ? getLayerWeightCount(layerIndex) / rows : 0;
+    if (outputIndex >= rows || inputIndex >= rowLength) {
+        std::cerr << "[ERROR] Weight (" << outputIndex << ", " << inputIndex << ") out of bounds for layer "
+                  << layerIndex << " (" << rows << " x " << rowLength << ")\n";
+        return false;
+    }
+    return setWeightRange(layerIndex, outputIndex * rowLength + inputIndex, &value, 1);
+}
+
+bool NeuralBuffers::setWeightRange(size_t layerIndex, uint64_t offset, const float* values, size_t count) {
+    if (m_config.streamWeights) {
+        std::cerr << "[ERROR] Weights are streamed in this mode, edit the streaming source instead\n";
+        return false;
+    }
+    if (!m_weightsUploaded) {
+        std::cerr << "[ERROR] Upload weights before editing them\n";
+        return false;
+    }
+    if (layerIndex >= m_layerInfo.size() || offset + count > getLayerWeightCount(layerIndex)) {
+        std::cerr << "[ERROR] Weight range out of bounds for layer " << layerIndex << "\n";
+        return false;
+    }
+
+    // First edit: build the shadow from what the GPU holds instead of copying every upload
+    if (m_hostWeights.empty()) {
+        readUnfoldedWeights(m_hostWeights);
+    }
+
+    const uint64_t begin = m_layerWeightStart[layerIndex] + offset;
+    std::copy(values, values + count, m_hostWeights.begin() + begin);
+    markDirty(m_dirtyWeights, begin, begin + count);
+    markLayerDirty(layerIndex);
+    m_weightsVersion++;
+    return true;
+}
+
+bool NeuralBuffers::setBias(size_t layerIndex, uint32_t outputIndex, float value) {
+    if (m_hostBiases.empty()) {
+        std::cerr << "[ERROR] Upload biases before editing them\n";
+        return false;
+    }
+    if (layerIndex >= m_layerDescs.size() || outputIndex >= layerBiasCount(m_layerDescs[layerIndex])) {
+        std::cerr << "[ERROR] Bias " << outputIndex << " out of bounds for layer " << layerIndex << "\n";
+        return false;
+    }
+
+    const uint64_t index = m_layerInfo[layerIndex].biasOffset + outputIndex;
+    m_hostBiases[index] = value;
+    markDirty(m_dirtyBiases, index, index + 1);
+    markLayerDirty(layerIndex);
+    m_weightsVersion++;
+    return true;
+}
+
+void NeuralBuffers::markDirty(std::map<uint64_t, uint64_t>& dirty, uint64_t begin, uint64_t end) {
+    // Absorb every interval that overlaps [begin, end) or lies within DIRTY_MERGE_GAP of it
+    auto it = dirty.upper_bound(begin);
+    if (it != dirty.begin() && std::prev(it)->second + DIRTY_MERGE_GAP >= begin) {
+        --it;
+    }
+    while (it != dirty.end() && it->first <= end + DIRTY_MERGE_GAP) {
+        begin = std::min(begin, it->first);
+        end = std::max(end, it->second);
+        it = dirty.erase(it);
+    }
+    dirty[begin] = end;
+}
+
+void NeuralBuffers::flushDirtyRanges() {
+    if (!m_dirtyWeights.empty()) {
+        if (hasRepackedStorage() || hasFolding()) {
+            // Storage is not a flat copy of the shadow: repack every layer an interval touches
+            for (size_t layer = 0; layer < m_layerInfo.size(); ++layer) {
+                const uint64_t first = m_layerWeightStart[layer];
+                const uint64_t last = first + getLayerWeightCount(layer);
+                auto it = m_dirtyWeights.lower_bound(last);
+                if (first < last && it != m_dirtyWeights.begin() && std::prev(it)->second > first) {
+                    uploadWeightStorage(first, last - first, m_hostWeights.data() + first);
+                }
+            }
+        } else {
+            for (const auto& [begin, end] : m_dirtyWeights) {
+                uploadWeightStorage(begin, end - begin, m_hostWeights.data() + begin);
+            }
+        }
+        m_dirtyWeights.clear();
+    }
+
+    if (!m_dirtyBiases.empty()) {
+        if (hasFolding()) {
+            uploadFoldedBiases();
+        } else {
+            for (const auto& [begin, end] : m_dirtyBiases) {
+                uploadRange(m_biasesSSBO, m_biasesMapped, m_totalBiases * sizeof(float),
+                            static_cast<GLintptr>(begin * sizeof(float)),
+                            static_cast<GLsizeiptr>((end - begin) * sizeof(float)), m_hostBiases.data() + begin);
+            }
+        }
+        m_dirtyBiases.clear();
+    }
 }
 
 void NeuralBuffers::uploadBiases(const std::vector<float>& biases) {
-    if (biases.size() != m_totalBiases) {
+    uploadBiases(biases.data(), biases.size());
+}
+
+void NeuralBuffers::uploadBiases(const float* biases, size_t count) {
+    if (count != m_totalBiases) {
         std::cerr << "[ERROR] Bias count mismatch. Expected "
-                  << m_totalBiases << ", got " << biases.size() << "\n";
+                  << m_totalBiases << ", got " << count << "\n";
         return;
     }
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_biasesSSBO);
-    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
-                    biases.size() * sizeof(float),
-                    biases.data());
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    // Kept so batch norm / input normalization can be re-folded when weights change
+    m_hostBiases.assign(biases, biases + count);
+    markLayerDirty(0);
+    m_weightsVersion++;
+    if (hasFolding()) {
+        uploadFoldedBiases();
+        return;
+    }
+
+    uploadRange(m_biasesSSBO, m_biasesMapped, m_totalBiases * sizeof(float),
+                0, count * sizeof(float), biases);
+}
+
+bool NeuralBuffers::setBatchNorm(size_t layerIndex, const BatchNorm& batchNorm) {
+    if (layerIndex >= m_layerInfo.size() || !m_layerDescs[layerIndex].hasWeights()) {
+        std::cerr << "[ERROR] Batch norm needs a dense or conv layer, got layer " << layerIndex << "\n";
+        return false;
+    }
+    if (isTied(layerIndex)) {
+        std::cerr << "[ERROR] Batch norm cannot fold into the shared weights of layer " << layerIndex << "\n";
+        return false;
+    }
+
+    const size_t channels = m_layerInfo[layerIndex].outputChannels;
+    if (batchNorm.gamma.size() != channels || batchNorm.beta.size() != channels ||
+        batchNorm.mean.size() != channels || batchNorm.variance.size() != channels) {
+        std::cerr << "[ERROR] Batch norm parameter count mismatch for layer " << layerIndex
+                  << ". Expected " << channels << " per parameter\n";
+        return false;
+    }
+
+    // y = scale * x + shift
+    auto& scale = m_bnScale[layerIndex];
+    auto& shift = m_bnShift[layerIndex];
+    scale.resize(channels);
+    shift.resize(channels);
+    for (size_t c = 0; c < channels; ++c) {
+        scale[c] = batchNorm.gamma[c] / std::sqrt(batchNorm.variance[c] + batchNorm.epsilon);
+        shift[c] = batchNorm.beta[c] - batchNorm.mean[c] * scale[c];
+    }
+    markLayerDirty(layerIndex);
+    m_weightsVersion++;
+    return true;
+}
+
+bool NeuralBuffers::setInputNormalization(const std::vector<float>& mean, const std::vector<float>& stddev) {
+    if (m_layerInfo.empty()) {
+        std::cerr << "[ERROR] Input normalization requires initialize() first\n";
+        return false;
+    }
+
+    // Zero padding of the raw input is not zero after normalization, so padded convs would differ at borders.
+    // Binary layers take the sign of the raw input, which normalization would move.
+    // Low-rank layers would need the scale folded into V and the shift through U * V.
+    // Shared weights would carry the input scale into the layers tied to the first one.
+    const LayerDesc& first = m_layerDescs[0];
+    if (!first.hasWeights() || first.kind == LayerKind::BinaryDense || first.kind == LayerKind::LowRankDense ||
+        (first.kind == LayerKind::Conv2D && first.padding != 0) || isTied(0)) {
+        std::cerr << "[ERROR] Input normalization can only fold into an untied dense or unpadded conv first layer\n";
+        return false;
+    }
+
+    const size_t channels = m_layerShapes[0].channels;
+    if (mean.size() != channels || stddev.size() != channels) {
+        std::cerr << "[ERROR] Input normalization size mismatch. Expected " << channels << " channels\n";
+        return false;
+    }
+
+    m_inputMean = mean;
+    m_inputScale.resize(channels);
+    for (size_t c = 0; c < channels; ++c) {
+        if (stddev[c] == 0.0f) {
+            std::cerr << "[ERROR] Input normalization stddev is zero for channel " << c << "\n";
+            m_inputMean.clear();
+            m_inputScale.clear();
+            return false;
+        }
+        m_inputScale[c] = 1.0f / stddev[c];
+    }
+    markLayerDirty(0);
+    m_weightsVersion++;
+    return true;
+}
+
+bool NeuralBuffers::hasFolding() const {
+    if (!m_inputScale.empty()) return true;
+    for (const auto& scale : m_bnScale) {
+        if (!scale.empty()) return true;
+    }
+    return false;
+}
+
+bool NeuralBuffers::isTied(size_t layerIndex) const {
+    if (m_layerDescs[layerIndex].tiedTo >= 0) return true;
+    return std::any_of(m_layerDescs.begin(), m_layerDescs.end(), [layerIndex](const LayerDesc& desc) {
+        return desc.tiedTo == static_cast<int32_t>(layerIndex);
+    });
+}
+
+bool NeuralBuffers::hasReducedPrecision() const {
+    return std::any_of(m_layerPrecision.begin(), m_layerPrecision.end(),
+                       [](Precision p) { return p != Precision::FP32; }) ||
+           std::any_of(m_layerDescs.begin(), m_layerDescs.end(),
+                       [](const LayerDesc& desc) { return desc.kind == LayerKind::BinaryDense; });
+}
+
+bool NeuralBuffers::hasRepackedStorage() const {
+    return m_config.weightLayout != WeightLayout::RowMajor || m_config.padToVec4 || hasReducedPrecision() ||
+           std::any_of(m_layerDescs.begin(), m_layerDescs.end(),
+                       [](const LayerDesc& desc) { return desc.kind == LayerKind::LowRankDense; });
+}
+
+const char* NeuralBuffers::precisionName(Precision precision) {
+    switch (precision) {
+        case Precision::FP16: return "fp16";
+        case Precision::INT8: return "int8";
+        case Precision::FP32:
+        default: return "fp32";
+    }
+}
+
+bool NeuralBuffers::loadPrecisionPolicy(const std::string& path, std::vector<Precision>& precisions) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "[ERROR] Failed to open precision policy: " << path << "\n";
+        return false;
+    }
+
+    std::map<size_t, Precision> entries;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream fields(line);
+        long long layer = -1;
+        std::string name;
+        if (!(fields >> layer)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;    // Blank
+            layer = -1;
+        }
+        fields >> name;
+
+        Precision precision = Precision::FP32;
+        if (name == "fp16") {
+            precision = Precision::FP16;
+        } else if (name == "int8") {
+            precision = Precision::INT8;
+        } else if (name != "fp32") {
+            layer = -1;
+        }
+        if (layer < 0 || entries.count(static_cast<size_t>(layer))) {
+            std::cerr << "[ERROR] " << path << ":" << lineNumber
+                      << ": expected a new \"<layer> <fp32|fp16|int8>\" entry\n";
+            return false;
+        }
+        entries[static_cast<size_t>(layer)] = precision;
+    }
+
+    if (entries.empty() || entries.rbegin()->first + 1 != entries.size()) {
+        std::cerr << "[ERROR] " << path << ": precision policy must list layers 0.."
+                  << (entries.empty() ? 0 : entries.rbegin()->first) << " once each\n";
+        return false;
+    }
+
+    precisions.clear();
+    for (const auto& entry : entries) {
+        precisions.push_back(entry.second);
+    }
+    return true;
+}
+
+bool NeuralBuffers::savePrecisionPolicy(const std::string& path, const std::vector<Precision>& precisions,
+                                        const std::vector<std::string>& comments) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[ERROR] Failed to write precision policy: " << path << "\n";
+        return false;
+    }
+
+    file << "# NeuraVis precision policy: <layer> <fp32|fp16|int8>\n";
+    for (size_t i = 0; i < precisions.size(); ++i) {
+        file << i << " " << precisionName(precisions[i]);
+        if (i < comments.size() && !comments[i].empty()) {
+            file << "  # " << comments[i];
+        }
+        file << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+void NeuralBuffers::foldChannels(const LayerInfo& info, uint64_t weight,
+                                 uint64_t& outChannel, uint64_t& inChannel) const {
+    // Dense: [out][in] with inputs in [c][y][x] order; conv: [outC][inC][ky][kx];
+    // low-rank: U [out][r] only (no input channel, see outputChannelWeights())
+    if (info.layerKind == static_cast<uint32_t>(LayerKind::Conv2D)) {
+        const uint64_t kernelArea = static_cast<uint64_t>(info.kernelSize) * info.kernelSize;
+        outChannel = weight / (info.inputChannels * kernelArea);
+        inChannel = (weight / kernelArea) % info.inputChannels;
+    } else if (info.layerKind == static_cast<uint32_t>(LayerKind::LowRankDense)) {
+        outChannel = weight / info.kernelSize;
+        inChannel = 0;
+    } else {
+        outChannel = weight / info.inputSize;
+        inChannel = (weight % info.inputSize) / (static_cast<uint64_t>(info.inputHeight) * info.inputWidth);
+    }
+}
+
+const float* NeuralBuffers::foldLayerWeights(size_t layerIndex, const float* canonical) {
+    const bool inputNorm = layerIndex == 0 && !m_inputScale.empty();
+    const auto& bnScale = m_bnScale[layerIndex];
+    if (!inputNorm && bnScale.empty()) {
+        return canonical;
+    }
+
+    const LayerInfo& info = m_layerInfo[layerIndex];
+    const uint64_t count = getLayerWeightCount(layerIndex);
+    m_foldScratch.assign(canonical, canonical + count);
+
+    // b' = b - sum(W * inputMean * inputScale)
+    if (inputNorm) {
+        m_inputBiasShift.assign(info.outputChannels, 0.0f);
+        for (uint64_t w = 0; w < count; ++w) {
+            uint64_t outChannel, inChannel;
+            foldChannels(info, w, outChannel, inChannel);
+            m_inputBiasShift[outChannel] -= canonical[w] * m_inputMean[inChannel] * m_inputScale[inChannel];
+        }
+    }
+
+    scaleFoldedWeights(layerIndex, m_foldScratch.data());
+    return m_foldScratch.data();
+}
+
+void NeuralBuffers::scaleFoldedWeights(size_t layerIndex, float* weights) const {
+    const LayerInfo& info = m_layerInfo[layerIndex];
+    const uint64_t count = getLayerWeightCount(layerIndex);
+
+    // W' = W * inputScale
+    if (layerIndex == 0 && !m_inputScale.empty()) {
+        for (uint64_t w = 0; w < count; ++w) {
+            uint64_t outChannel, inChannel;
+            foldChannels(info, w, outChannel, inChannel);
+            weights[w] *= m_inputScale[inChannel];
+        }
+    }
+
+    // W'' = W' * bnScale (the bias side is handled by uploadFoldedBiases)
+    const auto& bnScale = m_bnScale[layerIndex];
+    if (!bnScale.empty()) {
+        for (uint64_t w = 0; w < outputChannelWeights(info, count); ++w) {
+            uint64_t outChannel, inChannel;
+            foldChannels(info, w, outChannel, inChannel);
+            weights[w] *= bnScale[outChannel];
+        }
+    }
+}
+
+void NeuralBuffers::uploadFoldedBiases() {
+    if (m_hostBiases.empty()) {
+        return;
+    }
+
+    std::vector<float> folded = m_hostBiases;
+    for (size_t c = 0; c < m_inputBiasShift.size(); ++c) {
+        folded[m_layerInfo[0].biasOffset + c] += m_inputBiasShift[c];
+    }
+    for (size_t layer = 0; layer < m_layerInfo.size(); ++layer) {
+        const auto& scale = m_bnScale[layer];
+        const auto& shift = m_bnShift[layer];
+        for (size_t c = 0; c < scale.size(); ++c) {
+            float& bias = folded[m_layerInfo[layer].biasOffset + c];
+            bias = scale[c] * bias + shift[c];
+        }
+    }
+
+    uploadRange(m_biasesSSBO, m_biasesMapped, m_totalBiases * sizeof(float),
+                0, folded.size() * sizeof(float), folded.data());
 }
 
 void NeuralBuffers::setInputs(const std::vector<float>& inputs) {
@@ -145,45 +1593,179 @@ void NeuralBuffers::setInputs(const std::vector<float>& inputs) {
         return;
     }
 
+    if (hasSparseInput()) {
+        std::vector<uint32_t> indices;
+        std::vector<float> values;
+        for (uint32_t i = 0; i < inputs.size(); ++i) {
+            if (inputs[i] != 0.0f) {
+                indices.push_back(i);
+                values.push_back(inputs[i]);
+            }
+        }
+        if (indices.size() <= m_config.maxActiveInputs) {
+            setInputs(indices, values);
+            return;
+        }
+        // Too many non-zeros for the sparse list: layer 0 reads the dense input range instead
+    }
+
     // Write to beginning of activations buffer (input layer)
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_activationsSSBO);
-    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
-                    inputs.size() * sizeof(float),
-                    inputs.data());
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    uploadRange(m_activationsSSBO, m_activationsMapped, m_activationBufferSize * sizeof(float),
+                m_activationOffsets[0] * sizeof(float), inputs.size() * sizeof(float), inputs.data());
+    m_hostInputs = inputs;
+    m_pendingInputs.clear();
+    m_sparseInputActive = false;
+    markLayerDirty(0);
+}
+
+void NeuralBuffers::setInputs(const std::vector<uint32_t>& indices, const std::vector<float>& values) {
+    if (!hasSparseInput()) {
+        std::cerr << "[ERROR] Sparse inputs require Config::sparseInput\n";
+        return;
+    }
+    if (indices.size() != values.size() || indices.size() > m_config.maxActiveInputs) {
+        std::cerr << "[ERROR] Sparse input needs matching index/value counts of at most "
+                  << m_config.maxActiveInputs << ", got " << indices.size() << "/" << values.size() << "\n";
+        return;
+    }
+
+    std::vector<SparseInput> entries(indices.size());
+    std::vector<float> inputs(m_topology[0], 0.0f);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] >= m_topology[0]) {
+            std::cerr << "[ERROR] Input index out of bounds: " << indices[i] << "\n";
+            return;
+        }
+        entries[i] = {indices[i], values[i]};
+        inputs[indices[i]] += values[i];    // Repeated indices add up, as in the gather
+    }
+
+    uploadRange(m_sparseInputSSBO, m_sparseInputMapped,
+                std::max(1u, m_config.maxActiveInputs) * sizeof(SparseInput),
+                0, static_cast<GLsizeiptr>(entries.size() * sizeof(SparseInput)), entries.data());
+    m_sparseInputCount = static_cast<uint32_t>(entries.size());
+    m_sparseInputActive = true;
+
+    // Dense copy for setInputDeltas(), which rebuilds the full input vector
+    m_hostInputs = std::move(inputs);
+    m_pendingInputs.clear();
+    markLayerDirty(0);
+}
+
+void NeuralBuffers::bindSparseInputs(GLuint binding) const {
+    if (m_sparseInputSSBO) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_sparseInputSSBO);
+    }
+}
+
+void NeuralBuffers::setInputDeltas(const std::vector<uint32_t>& indices, const std::vector<float>& values) {
+    if (indices.size() != values.size()) {
+        std::cerr << "[ERROR] Input delta count mismatch: " << indices.size() << " indices, "
+                  << values.size() << " values\n";
+        return;
+    }
+    for (uint32_t index : indices) {
+        if (index >= m_topology[0]) {
+            std::cerr << "[ERROR] Input index out of bounds: " << index << "\n";
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        m_pendingInputs[indices[i]] = values[i];
+    }
+
+    // Too many changes for a rank-k update to pay off: upload the inputs as a whole
+    if (!supportsInputDeltas() || m_pendingInputs.size() > MAX_INPUT_DELTAS) {
+        std::vector<float> inputs = m_hostInputs;
+        for (const auto& [index, value] : m_pendingInputs) {
+            inputs[index] = value;
+        }
+        setInputs(inputs);
+        return;
+    }
+
+    // The delta pass brings layer 0 up to date if its pre-activations are current;
+    // otherwise it only writes the inputs and layer 0 is recomputed in full
+    markLayerDirty(m_preActivationsValid ? 1 : 0);
+}
+
+uint32_t NeuralBuffers::bindInputDeltas(GLuint preActivationBinding, GLuint deltaBinding) {
+    std::vector<InputDelta> deltas;
+    deltas.reserve(m_pendingInputs.size());
+    for (const auto& [index, value] : m_pendingInputs) {
+        deltas.push_back({index, value - m_hostInputs[index], value, 0});
+        m_hostInputs[index] = value;
+    }
+    m_pendingInputs.clear();
+
+    uploadRange(m_inputDeltaSSBO, m_inputDeltaMapped, MAX_INPUT_DELTAS * sizeof(InputDelta),
+                0, static_cast<GLsizeiptr>(deltas.size() * sizeof(InputDelta)), deltas.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, preActivationBinding, m_preActivationSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, deltaBinding, m_inputDeltaSSBO);
+    return static_cast<uint32_t>(deltas.size());
+}
+
+void NeuralBuffers::bindPreActivations(GLuint binding) const {
+    if (m_preActivationSSBO) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_preActivationSSBO);
+    }
 }
 
 void NeuralBuffers::clearActivations() {
-    // Zero out entire activation buffer
-    std::vector<float> zeros(m_totalNeurons, 0.0f);
+    // Zero out entire activation buffer (including vec4 padding)
+    std::vector<float> zeros(m_activationBufferSize, 0.0f);
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_activationsSSBO);
-    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
-                    m_totalNeurons * sizeof(float),
-                    zeros.data());
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    uploadRange(m_activationsSSBO, m_activationsMapped, m_activationBufferSize * sizeof(float),
+                0, m_activationBufferSize * sizeof(float), zeros.data());
+    m_hostInputs.assign(m_topology[0], 0.0f);
+    m_pendingInputs.clear();
+    m_sparseInputCount = 0;
+    m_sparseInputActive = hasSparseInput();
+    markLayerDirty(0);
 }
 
 void NeuralBuffers::uploadActivations(const std::vector<float>& activations) {
+    if (m_config.reuseActivations) {
+        std::cerr << "[ERROR] uploadActivations needs every layer resident (reuseActivations is set)\n";
+        return;
+    }
     if (activations.size() != m_totalNeurons) {
         std::cerr << "[ERROR] Activation count mismatch. Expected "
                   << m_totalNeurons << ", got " << activations.size() << "\n";
         return;
     }
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_activationsSSBO);
-    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
-                    activations.size() * sizeof(float),
-                    activations.data());
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    // Arbitrary values (e.g. animation frames) are not the result of the current inputs
+    m_hostInputs.assign(activations.begin(), activations.begin() + m_topology[0]);
+    m_pendingInputs.clear();
+    markLayerDirty(0);
+
+    if (m_activationBufferSize == m_totalNeurons) {
+        uploadRange(m_activationsSSBO, m_activationsMapped, m_activationBufferSize * sizeof(float),
+                    0, activations.size() * sizeof(float), activations.data());
+        return;
+    }
+
+    // Scatter the compact per-neuron values into the padded layout
+    std::vector<float> padded(m_activationBufferSize, 0.0f);
+    uint32_t compactOffset = 0;
+    for (size_t layer = 0; layer < m_topology.size(); ++layer) {
+        std::copy_n(activations.begin() + compactOffset, m_topology[layer],
+                    padded.begin() + m_activationOffsets[layer]);
+        compactOffset += m_topology[layer];
+    }
+
+    uploadRange(m_activationsSSBO, m_activationsMapped, m_activationBufferSize * sizeof(float),
+                0, padded.size() * sizeof(float), padded.data());
 }
 
 void NeuralBuffers::readOutputs(std::vector<float>& outputs) const {
     uint32_t outputSize = m_topology.back();
     outputs.resize(outputSize);
 
-    // Calculate offset to last layer
-    uint32_t offset = m_totalNeurons - outputSize;
+    // Offset to last layer
+    uint32_t offset = m_activationOffsets.back();
 
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_activationsSSBO);
     glGetBufferSubData(GL_SHADER_STORAGE_BUFFER,
@@ -193,39 +1775,180 @@ void NeuralBuffers::readOutputs(std::vector<float>& outputs) const {
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
 
+void NeuralBuffers::readTopK(std::vector<TopKEntry>& entries) const {
+    if (!m_topKSSBO) {
+        entries.clear();
+        return;
+    }
+    entries.resize(std::min(m_config.topK, m_topology.back()));
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_topKSSBO);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, entries.size() * sizeof(TopKEntry), entries.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
 void NeuralBuffers::readAllActivations(std::vector<float>& activations) const {
+    if (m_config.reuseActivations) {
+        std::cerr << "[ERROR] readAllActivations needs every layer resident (reuseActivations is set)\n";
+        activations.clear();
+        return;
+    }
     activations.resize(m_totalNeurons);
 
+    if (m_activationBufferSize == m_totalNeurons) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_activationsSSBO);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+                           m_totalNeurons * sizeof(float),
+                           activations.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        return;
+    }
+
+    // Gather the padded layout back into one value per neuron
+    std::vector<float> padded(m_activationBufferSize);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_activationsSSBO);
     glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
-                       m_totalNeurons * sizeof(float),
-                       activations.data());
+                       m_activationBufferSize * sizeof(float),
+                       padded.data());
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    uint32_t compactOffset = 0;
+    for (size_t layer = 0; layer < m_topology.size(); ++layer) {
+        std::copy_n(padded.begin() + m_activationOffsets[layer], m_topology[layer],
+                    activations.begin() + compactOffset);
+        compactOffset += m_topology[layer];
+    }
 }
 
 void NeuralBuffers::readWeights(std::vector<float>& weights) const {
+    if (m_config.streamWeights) {
+        // Only a window is resident: rebuild what bindLayerWeights() would page in, by
+        // folding and round-tripping each layer of the source through its storage format
+        weights.assign(m_totalWeights, 0.0f);
+        if (!m_streamingSource) {
+            return;
+        }
+        std::vector<float> packed;
+        for (size_t layer = 0; layer < m_layerInfo.size(); ++layer) {
+            const LayerInfo& info = m_layerInfo[layer];
+            const uint64_t count = getLayerWeightCount(layer);
+            if (count == 0) continue;
+
+            float* layerWeights = weights.data() + m_layerWeightStart[layer];
+            std::copy(m_streamingSource + m_layerWeightStart[layer],
+                      m_streamingSource + m_layerWeightStart[layer] + count, layerWeights);
+            scaleFoldedWeights(layer, layerWeights);
+            packed.resize(layerStorageSize(info));
+            packLayerWeights(info, layerWeights, packed.data());
+            unpackLayerWeights(info, packed.data(), layerWeights);
+        }
+        return;
+    }
+
     weights.resize(m_totalWeights);
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_weightsSSBO);
-    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
-                       m_totalWeights * sizeof(float),
-                       weights.data());
+    if (hasRepackedStorage()) {
+        // Read each layer in storage layout and convert back to row-major
+        std::vector<float> packed;
+        for (size_t layer = 0; layer < m_layerInfo.size(); ++layer) {
+            // Tied layers have nothing of their own to read back
+            const LayerInfo& info = m_layerInfo[layer];
+            if (getLayerWeightCount(layer) == 0) continue;
+            packed.resize(layerStorageSize(info));
+
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_weightShards[info.weightShard].buffer);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                               static_cast<GLintptr>(info.weightOffset) * sizeof(float),
+                               static_cast<GLsizeiptr>(packed.size() * sizeof(float)),
+                               packed.data());
+            unpackLayerWeights(info, packed.data(), weights.data() + m_layerWeightStart[layer]);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        return;
+    }
+
+    // Concatenate shards back into the flat layout
+    for (const auto& shard : m_weightShards) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, shard.buffer);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+                           static_cast<GLsizeiptr>(shard.size * sizeof(float)),
+                           weights.data() + shard.globalOffset);
+    }
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
 
+void NeuralBuffers::readUnfoldedWeights(std::vector<float>& weights) const {
+    readWeights(weights);
+
+    if (!hasFolding()) {
+        return;
+    }
+
+    for (size_t layer = 0; layer < m_layerInfo.size(); ++layer) {
+        const bool inputNorm = layer == 0 && !m_inputScale.empty();
+        const auto& bnScale = m_bnScale[layer];
+        if (!inputNorm && bnScale.empty()) continue;
+
+        const LayerInfo& info = m_layerInfo[layer];
+        float* layerWeights = weights.data() + m_layerWeightStart[layer];
+        // Input normalization never folds into a low-rank layer, so U's rows are all there is
+        const uint64_t count = outputChannelWeights(info, getLayerWeightCount(layer));
+        for (uint64_t w = 0; w < count; ++w) {
+            uint64_t outChannel, inChannel;
+            foldChannels(info, w, outChannel, inChannel);
+            float value = layerWeights[w];
+            if (!bnScale.empty()) {
+                value = bnScale[outChannel] != 0.0f ? value / bnScale[outChannel] : 0.0f;
+            }
+            if (inputNorm) {
+                value /= m_inputScale[inChannel];
+            }
+            layerWeights[w] = value;
+        }
+    }
+}
+
 void NeuralBuffers::bindBuffers(GLuint weightsBinding,
                                  GLuint biasesBinding,
-                                 GLuint activationsBinding) const {
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, weightsBinding, m_weightsSSBO);
+                                 GLuint activationsBinding,
+                                 GLuint topKBinding) const {
+    // First shard only - per-layer shards are bound by bindLayerWeights()
+    GLuint weights = m_weightShards.empty() ? 0 : m_weightShards[0].buffer;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, weightsBinding, weights);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, biasesBinding, m_biasesSSBO);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, activationsBinding, m_activationsSSBO);
+    if (m_topKSSBO) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, topKBinding, m_topKSSBO);
+    }
 }
 
 void NeuralBuffers::cleanup() {
-    if (m_weightsSSBO) {
-        glDeleteBuffers(1, &m_weightsSSBO);
-        m_weightsSSBO = 0;
+    // Deleting a buffer implicitly unmaps it
+    m_biasesMapped = nullptr;
+    m_activationsMapped = nullptr;
+
+    for (auto& shard : m_weightShards) {
+        if (shard.buffer) {
+            glDeleteBuffers(1, &shard.buffer);
+        }
     }
+    m_weightShards.clear();
+    for (auto& slot : m_weightSlots) {
+        glDeleteBuffers(1, &slot.buffer);
+    }
+    m_weightSlots.clear();
+    for (int i = 0; i < 2; ++i) {
+        if (m_stagingFences[i]) {
+            glDeleteSync(m_stagingFences[i]);
+            m_stagingFences[i] = nullptr;
+        }
+        if (m_stagingBuffers[i]) {
+            glDeleteBuffers(1, &m_stagingBuffers[i]);
+            m_stagingBuffers[i] = 0;
+        }
+        m_stagingMapped[i] = nullptr;
+    }
+    m_streamingSource = nullptr;
     if (m_biasesSSBO) {
         glDeleteBuffers(1, &m_biasesSSBO);
         m_biasesSSBO = 0;
@@ -234,4 +1957,24 @@ void NeuralBuffers::cleanup() {
         glDeleteBuffers(1, &m_activationsSSBO);
         m_activationsSSBO = 0;
     }
+    if (m_topKSSBO) {
+        glDeleteBuffers(1, &m_topKSSBO);
+        m_topKSSBO = 0;
+    }
+    if (m_preActivationSSBO) {
+        glDeleteBuffers(1, &m_preActivationSSBO);
+        m_preActivationSSBO = 0;
+    }
+    if (m_sparseInputSSBO) {
+        glDeleteBuffers(1, &m_sparseInputSSBO);
+        m_sparseInputSSBO = 0;
+    }
+    m_sparseInputMapped = nullptr;
+    m_sparseInputCount = 0;
+    m_sparseInputActive = false;
+    if (m_inputDeltaSSBO) {
+        glDeleteBuffers(1, &m_inputDeltaSSBO);
+        m_inputDeltaSSBO = 0;
+    }
+    m_inputDeltaMapped = nullptr;
 }
\ No newline at end of file
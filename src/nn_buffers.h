@@ -1,7 +1,12 @@
 #pragma once
 
+#include "layer_desc.h"
 #include <glad/glad.h>
+#include <algorithm>
+#include <map>
+#include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 /**
@@ -21,12 +26,181 @@ public:
     struct LayerInfo {
         uint32_t inputSize;
         uint32_t outputSize;
-        uint32_t weightOffset;     // Offset into weights buffer (in floats)
+        uint32_t weightOffset;     // Offset into this layer's weight shard (in floats)
         uint32_t biasOffset;       // Offset into biases buffer (in floats)
-        uint32_t activationType;   // 0=ReLU, 1=Sigmoid, 2=Tanh
+        uint32_t activationType;   // Activation (0=ReLU, 1=Sigmoid, 2=Tanh, 3=Linear, 4=Softmax)
         uint32_t inputOffset;      // Offset into activations buffer for inputs
         uint32_t outputOffset;     // Offset into activations buffer for outputs
-        uint32_t _padding[1];      // Align to 32 bytes for std140
+        uint32_t weightShard;      // Index of the weights SSBO shard holding this layer
+
+        // Layer kind and feature map geometry (dense layers: C x 1 x 1, conv fields unused)
+        uint32_t layerKind;        // LayerKind (0=Dense, 1=Conv2D, 2=MaxPool2D, 3=AvgPool2D, 4=BinaryDense,
+                                   //            5=LowRankDense)
+        uint32_t inputChannels;
+        uint32_t inputHeight;
+        uint32_t inputWidth;
+        uint32_t outputChannels;
+        uint32_t outputHeight;
+        uint32_t outputWidth;
+        uint32_t kernelSize;       // Square kernel / pooling window (LowRankDense: rank)
+        uint32_t stride;           // Conv/pooling; dense: source row stride of a transposed tie, else 0
+        uint32_t padding;          // Zero padding on every side
+        uint32_t residualOffset;   // Activations offset of the skip input, NO_RESIDUAL if none
+        uint32_t weightPrecision;  // Precision of the stored weights (dense layers only)
+    };
+
+    static constexpr uint32_t NO_RESIDUAL = 0xFFFFFFFFu;  // Must match the shaders
+
+    /**
+     * @brief Activation function per layer (LayerInfo::activationType)
+     *
+     * Softmax normalizes over the whole layer, so a softmax layer is dispatched as a
+     * single workgroup that reduces max and sum in shared memory.
+     */
+    enum class Activation : uint32_t {
+        ReLU = 0,
+        Sigmoid = 1,
+        Tanh = 2,
+        Linear = 3,
+        Softmax = 4
+    };
+
+    /**
+     * @brief One entry of the fused top-k result (see Config::topK)
+     * Matches the std430 TopKEntry struct in forward.comp
+     */
+    struct TopKEntry {
+        uint32_t index;            // Output neuron
+        float probability;         // Softmax output of that neuron
+    };
+
+    static constexpr uint32_t MAX_TOP_K = 16;  // Must match forward.comp
+
+    /**
+     * @brief Storage precision of a dense layer's weights (LayerInfo::weightPrecision)
+     *
+     * uploadWeights()/readWeights() always take fp32; reduced precisions are converted at
+     * upload time (readWeights() returns the rounded values). Activations, biases and
+     * accumulation stay fp32 - only weight bandwidth and memory shrink:
+     * - FP32: as configured by WeightLayout and padToVec4
+     * - FP16: row-major, two halves per 32-bit word (unpackHalf2x16)
+     * - INT8: row-major, per row one fp32 scale (max |w|) followed by four symmetric
+     *         int8 values per word (unpackSnorm4x8 * scale)
+     * Reduced-precision layers ignore WeightLayout, and their storage is rounded up to a
+     * multiple of 4 floats so the next layer stays vec4 aligned.
+     */
+    enum class Precision : uint32_t {
+        FP32 = 0,
+        FP16 = 1,
+        INT8 = 2
+    };
+
+    /**
+     * @brief Inference-time batch norm on a layer's pre-activation output (per output channel)
+     *
+     * y = gamma * (x - mean) / sqrt(variance + epsilon) + beta, folded into the layer's
+     * weights and biases at upload time (see setBatchNorm()).
+     */
+    struct BatchNorm {
+        std::vector<float> gamma;
+        std::vector<float> beta;
+        std::vector<float> mean;
+        std::vector<float> variance;
+        float epsilon = 1e-5f;
+    };
+
+    // conv2d.comp computes CONV_TILE x CONV_TILE outputs per workgroup from a shared-memory
+    // input patch of (CONV_TILE - 1) * stride + kernelSize per side, at most CONV_MAX_PATCH
+    static constexpr uint32_t CONV_TILE = 16;
+    static constexpr uint32_t CONV_MAX_PATCH = 40;
+
+    // binary_dense.comp packs a binary layer's whole input into shared memory as sign bits
+    static constexpr uint32_t MAX_BINARY_INPUTS = 32768;    // 1024 words, must match the shader
+
+    // low_rank_dense.comp keeps a low-rank layer's bottleneck vector in shared memory
+    static constexpr uint32_t MAX_LOW_RANK = 1024;          // Must match the shader
+
+    /**
+     * @brief How host data is transferred into the SSBOs
+     *
+     * - SubData:       glBufferSubData (driver copies into its own staging memory)
+     * - MapRange:      glMapBufferRange with GL_MAP_INVALIDATE_RANGE_BIT + memcpy
+     * - Orphan:        glBufferData(nullptr) then glBufferSubData for whole-buffer writes
+     *                  (partial writes fall back to SubData)
+     * - PersistentMap: glBufferStorage + persistent coherent mapping, written with memcpy
+     *                  after a fence wait (the GPU may still be reading the old data).
+     *                  Every upload, including each setInputs(), drains all queued GPU
+     *                  work, so this is a fully synchronous baseline, not a streaming
+     *                  path: there is a single copy of each buffer and no ring of regions.
+     */
+    enum class UploadStrategy : uint32_t {
+        SubData = 0,
+        MapRange,
+        Orphan,
+        PersistentMap
+    };
+
+    /**
+     * @brief How each layer's weights are stored on the GPU
+     *
+     * uploadWeights()/readWeights() always use the row-major [out][in] layout;
+     * other layouts are converted transparently so GPU reads coalesce:
+     * - RowMajor:   [out][in]            thread o reads row o (strided across threads)
+     * - InputMajor: [in][out]            threads read consecutive floats for each input
+     * - Tiled4:     [in/4][out][4]       each thread reads 16 contiguous bytes per 4 inputs,
+     *                                    inputs padded with zeros to a multiple of 4
+     */
+    enum class WeightLayout : uint32_t {
+        RowMajor = 0,
+        InputMajor = 1,
+        Tiled4 = 2
+    };
+
+    struct Config {
+        UploadStrategy uploadStrategy = UploadStrategy::SubData;
+        WeightLayout weightLayout = WeightLayout::RowMajor;
+
+        // Out-of-core mode: only streamingWindow layers' weights are resident on the GPU.
+        // Weights come from setStreamingSource() (e.g. a mapped model file) instead of uploadWeights()
+        bool streamWeights = false;
+        uint32_t streamingWindow = 2;    // Resident weight slots (minimum 2: current + prefetched)
+
+        // Upper bound per weights SSBO shard; 0 = GL_MAX_SHADER_STORAGE_BLOCK_SIZE
+        uint64_t maxShardBytes = 0;
+
+        // Round every layer's activation range and weight row stride up to a multiple of 4
+        // so forward.comp can use vec4 loads and dot(). Padding is zero and invisible to
+        // setInputs/readOutputs/readAllActivations/uploadActivations and the renderer.
+        // Conv weight storage is rounded up to a multiple of 4 so later layers stay aligned.
+        bool padToVec4 = false;
+
+        // Fused argmax/top-k: when the output layer is softmax, its dispatch also writes the
+        // topK most probable (index, probability) pairs, read back with readTopK().
+        // 0 = disabled, 1 = argmax, at most MAX_TOP_K
+        uint32_t topK = 0;
+
+        // Sparse input mode: setInputs() takes active (index, value) pairs, at most
+        // maxActiveInputs, and the dense first layer gathers just those weight columns.
+        // A dense setInputs() with more non-zeros than that uploads the input range and
+        // layer 0 reads it densely until the next sparse upload.
+        bool sparseInput = false;
+        uint32_t maxActiveInputs = 256;
+
+        // Serving mode: activation ranges are assigned from liveness instead of keeping every
+        // layer resident. Layers alternate between the two ends of a ping-pong arena sized to
+        // the largest adjacent pair; residual sources get their own ranges for as long as they
+        // are live. Only the output layer is valid after forward(), and the input is overwritten,
+        // so call setInputs() before every pass. readAllActivations/uploadActivations and the
+        // renderer need every layer and are unavailable.
+        bool reuseActivations = false;
+
+        // Per-layer weight precision (one entry per computed layer, empty = all FP32).
+        // Conv and pooling layers must stay FP32.
+        std::vector<Precision> layerPrecision;
+
+        // Precision policy file (see loadPrecisionPolicy); when set, initialize() reads it
+        // and it replaces layerPrecision. Written by the neuravis_precision tool.
+        std::string precisionPolicyPath;
     };
 
     NeuralBuffers() = default;
@@ -36,19 +210,58 @@ public:
     NeuralBuffers(const NeuralBuffers&) = delete;
     NeuralBuffers& operator=(const NeuralBuffers&) = delete;
 
+    /**
+     * @brief Set buffer configuration
+     * Must be called before initialize() - buffer storage depends on it
+     */
+    void setConfig(const Config& config) { m_config = config; }
+
+    /**
+     * @brief Get current buffer configuration
+     */
+    const Config& getConfig() const { return m_config; }
+
     /**
      * @brief Initialize buffers for a network topology
      * @param layerSizes Size of each layer (e.g., {2, 2, 1} for XOR)
      * @param activations Activation type per layer (same length as layerSizes - 1)
+     * @return false if the topology is invalid or exceeds GPU limits
+     *
+     * Weights are split into shards of at most GL_MAX_SHADER_STORAGE_BLOCK_SIZE bytes
+     * (and 2^32 - 1 floats), each holding whole layers; LayerInfo carries the shard index and local offset.
      */
-    void initialize(const std::vector<uint32_t>& layerSizes,
+    bool initialize(const std::vector<uint32_t>& layerSizes,
                     const std::vector<uint32_t>& activations);
 
+    /**
+     * @brief Initialize buffers for a network of dense and convolution layers
+     * @param inputShape Shape of the input feature map (e.g., {1, 28, 28})
+     * @param layers One descriptor per computed layer
+     * @return false if a layer does not fit its input or exceeds GPU limits
+     *
+     * The topology becomes the flattened size of each layer's feature map, so
+     * setInputs/readOutputs and the activations SSBO work as for dense networks.
+     */
+    bool initialize(const TensorShape& inputShape, const std::vector<LayerDesc>& layers);
+
     /**
      * @brief Upload weight data to GPU
      * @param weights Flat array of all weights (concatenated per layer)
+     * @return false if the size does not match (nothing is uploaded)
+     */
+    bool uploadWeights(const std::vector<float>& weights);
+
+    /**
+     * @brief Upload a range of weights straight from caller memory (e.g. a mapped model file)
+     * @param weights Pointer to count floats
+     * @param count Number of floats to upload
+     * @param offset Destination offset into the flat weights array (in floats)
+     *
+     * With repacked storage (hasRepackedStorage()) or folding (hasFolding()) the range
+     * must cover whole layers.
+     * @return false if the range is out of bounds or splits a layer; nothing is changed then
      */
-    void uploadWeights(const std::vector<float>& weights);
+    bool uploadWeights(const float* weights, size_t count, size_t offset = 0);
 
     /**
      * @brief Upload bias data to GPU
@@ -56,12 +269,210 @@ public:
      */
     void uploadBiases(const std::vector<float>& biases);
 
+    /**
+     * @brief Upload all biases straight from caller memory
+     * @param biases Pointer to count floats
+     * @param count Number of floats (must equal total bias count)
+     */
+    void uploadBiases(const float* biases, size_t count);
+
+    /**
+     * @brief Edit one weight; it reaches the GPU on the next flushDirtyRanges()
+     * @param layerIndex Dense or conv layer (low-rank layers are edited through setWeightRange())
+     * @param outputIndex Output neuron (conv: output channel)
+     * @param inputIndex Position in that output's weight row (conv: [inC][ky][kx] flattened)
+     * @return false if the index is out of range, weights were never uploaded, or weights are streamed
+     *
+     * The first edit reads the weights back into a CPU shadow of the row-major weights
+     * (reduced-precision layers keep their stored values); edits write the shadow and mark
+     * the element dirty, so a live edit never re-validates or re-uploads the network.
+     * uploadWeights() itself keeps no host copy until then.
+     */
+    bool setWeight(size_t layerIndex, uint32_t outputIndex, uint32_t inputIndex, float value);
+
+    /**
+     * @brief Edit count consecutive weights of a layer
+     * @param offset Start within the layer's flat [out][in] array (getLayerWeightCount() floats)
+     */
+    bool setWeightRange(size_t layerIndex, uint64_t offset, const float* values, size_t count);
+
+    /**
+     * @brief Edit one bias (conv: per output channel); uploaded by flushDirtyRanges()
+     */
+    bool setBias(size_t layerIndex, uint32_t outputIndex, float value);
+
+    /**
+     * @brief Upload everything edited since the last flush
+     *
+     * Dirty intervals are coalesced as they are marked; gaps of up to DIRTY_MERGE_GAP floats
+     * are re-uploaded rather than costing another call. Row-major unpadded weights upload just
+     * the intervals; other layouts and folded layers repack each touched layer. Called by
+     * NeuralCompute::forward(), so any number of edits costs one flush per frame.
+     */
+    void flushDirtyRanges();
+
+    /**
+     * @brief Check whether edits are waiting for flushDirtyRanges()
+     */
+    bool hasDirtyRanges() const { return !m_dirtyWeights.empty() || !m_dirtyBiases.empty(); }
+
+    static constexpr uint64_t DIRTY_MERGE_GAP = 256;    // Floats
+
+    /**
+     * @brief One active input in sparse input mode (matches forward.comp)
+     */
+    struct SparseInput {
+        uint32_t index;
+        float value;
+    };
+
+    /**
+     * @brief One changed input for the sparse first-layer update (matches input_delta.comp)
+     */
+    struct InputDelta {
+        uint32_t index;
+        float delta;        // New value minus the value layer 0 was computed from
+        float value;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(InputDelta) == 16, "InputDelta must match the std430 layout");
+
+    static constexpr uint32_t MAX_INPUT_DELTAS = 256;   // Per pass; more fall back to setInputs()
+
+    /**
+     * @brief Change a few inputs without recomputing the whole first layer
+     * @param indices Input neurons to change
+     * @param values Their new values
+     *
+     * When the first layer is dense (not softmax, no residual) its pre-activations stay
+     * resident, and the next forward pass applies the changes as a rank-k update
+     * z += W[:, j] * dx_j in input_delta.comp, then re-runs only layers 1..N through
+     * NeuralCompute::forwardIncremental(). Otherwise, or past MAX_INPUT_DELTAS pending
+     * changes, this falls back to a full setInputs().
+     */
+    void setInputDeltas(const std::vector<uint32_t>& indices, const std::vector<float>& values);
+
+    /**
+     * @brief Check whether the first layer keeps pre-activations for input deltas
+     */
+    bool supportsInputDeltas() const { return m_preActivationSSBO != 0; }
+
+    /**
+     * @brief Check whether setInputDeltas() changes are waiting for a forward pass
+     */
+    bool hasPendingInputDeltas() const { return !m_pendingInputs.empty(); }
+
+    /**
+     * @brief Upload the pending input deltas and bind them with the pre-activations
+     * @return Number of deltas bound (the pending set is cleared)
+     */
+    uint32_t bindInputDeltas(GLuint preActivationBinding = 4, GLuint deltaBinding = 5);
+
+    /**
+     * @brief Bind the layer 0 pre-activations written by forward.comp
+     */
+    void bindPreActivations(GLuint binding = 4) const;
+
+    /**
+     * @brief Attach batch norm to a dense or conv layer's pre-activation output
+     * @param layerIndex Layer the batch norm follows
+     * @param batchNorm Per output channel parameters (dense layers: per output neuron)
+     * @return false if the layer has no weights of its own (or shares them), or the parameter sizes do not match
+     *
+     * Folded into the layer's weights and biases by uploadWeights()/uploadBiases()
+     * (and by streaming), so it costs nothing at inference. Set it before uploading.
+     */
+    bool setBatchNorm(size_t layerIndex, const BatchNorm& batchNorm);
+
+    /**
+     * @brief Normalize network inputs as (x - mean) / stddev per input channel
+     * @param mean Per input channel mean (dense inputs: per input neuron)
+     * @param stddev Per input channel standard deviation (non-zero)
+     * @return false if sizes do not match, or the first layer is not an untied dense or unpadded conv
+     *
+     * Folded into the first layer's weights and biases at upload time; setInputs() still
+     * takes raw inputs. Set it before uploading.
+     */
+    bool setInputNormalization(const std::vector<float>& mean, const std::vector<float>& stddev);
+
+    /**
+     * @brief Check whether any batch norm or input normalization is folded into the weights
+     */
+    bool hasFolding() const;
+
+    /**
+     * @brief Check whether a layer shares its weight matrix (LayerDesc::tiedTo, either side of the tie)
+     */
+    bool isTied(size_t layerIndex) const;
+
+    /**
+     * @brief Check whether any layer stores its weights below fp32 (Config::layerPrecision
+     *        or LayerKind::BinaryDense)
+     */
+    bool hasReducedPrecision() const;
+
+    /**
+     * @brief Check whether the GPU weight storage differs from the flat uploadWeights() array
+     *
+     * True for non-row-major or padded layouts, reduced precision, and binary or low-rank
+     * layers. Such weights are converted per layer on upload and on readWeights().
+     * Tied layers are not repacked: they own no entries and read their source's storage.
+     */
+    bool hasRepackedStorage() const;
+
+    /**
+     * @brief Read a precision policy file
+     * @param path Text file with one "<layer> <fp32|fp16|int8>" line per computed layer
+     * @param precisions Filled with one entry per layer, in layer order
+     * @return false if the file is missing or malformed
+     *
+     * Blank lines and anything after '#' are ignored; every layer from 0 to the highest
+     * listed index must appear exactly once.
+     */
+    static bool loadPrecisionPolicy(const std::string& path, std::vector<Precision>& precisions);
+
+    /**
+     * @brief Write a precision policy file readable by loadPrecisionPolicy()
+     * @param comments Optional per-layer note appended to each line as a comment
+     */
+    static bool savePrecisionPolicy(const std::string& path, const std::vector<Precision>& precisions,
+                                    const std::vector<std::string>& comments = {});
+
+    static const char* precisionName(Precision precision);
+
     /**
      * @brief Set input activations (first layer)
      * @param inputs Input values to network
      */
     void setInputs(const std::vector<float>& inputs);
 
+    /**
+     * @brief Set sparse inputs (Config::sparseInput): every input not listed is zero
+     * @param indices Active input neurons (at most Config::maxActiveInputs)
+     * @param values Their values (1 for one-hot)
+     *
+     * Uploads 8 bytes per active input; the first layer costs O(active) per output.
+     * The dense overload still works in sparse mode: it keeps the non-zero inputs, or
+     * uploads the whole vector when there are more than maxActiveInputs of them.
+     */
+    void setInputs(const std::vector<uint32_t>& indices, const std::vector<float>& values);
+
+    /**
+     * @brief Check whether sparse input mode is enabled
+     */
+    bool hasSparseInput() const { return m_sparseInputSSBO != 0; }
+
+    /**
+     * @brief Check whether the first layer gathers the sparse list (false after a dense fallback)
+     */
+    bool isSparseInputActive() const { return m_sparseInputActive; }
+    uint32_t getSparseInputCount() const { return m_sparseInputCount; }
+
+    /**
+     * @brief Bind the active inputs read by the first layer in sparse input mode
+     */
+    void bindSparseInputs(GLuint binding = 6) const;
+
     /**
      * @brief Clear all activations (zero out activation buffer)
      * Call this when switching inputs to reset network state
@@ -80,6 +491,20 @@ public:
      */
     void readOutputs(std::vector<float>& outputs) const;
 
+    /**
+     * @brief Read the fused top-k result of the last forward pass
+     * @param entries Vector to store Config::topK entries, most probable first
+     *
+     * Reads topK * 8 bytes instead of the whole output layer. Empty if top-k is
+     * disabled or the output layer is not softmax.
+     */
+    void readTopK(std::vector<TopKEntry>& entries) const;
+
+    /**
+     * @brief Check whether the output layer writes a fused top-k result
+     */
+    bool hasTopK() const { return m_topKSSBO != 0; }
+
     /**
      * @brief Read all activations from GPU (for visualization)
      * @param activations Vector to store all activation values
@@ -88,19 +513,102 @@ public:
 
     /**
      * @brief Read all weights from GPU (for connection visualization)
-     * @param weights Vector to store all weight values
+     * @param weights Vector to store all weight values (row-major, whatever the storage layout)
+     *
+     * Reduced-precision layers return the rounded values, binary layers +-alpha per row,
+     * and folded batch norm / input normalization is included. In streaming mode the same
+     * values are rebuilt on the CPU from the streaming source.
      */
     void readWeights(std::vector<float>& weights) const;
 
+    /**
+     * @brief Read weights as uploaded, with batch norm / input normalization folding undone
+     * @param weights Vector to store all weight values (row-major)
+     *
+     * For visualization: shows the trained network instead of the folded inference weights.
+     * Channels with a zero batch-norm scale unfold to zero.
+     */
+    void readUnfoldedWeights(std::vector<float>& weights) const;
+
     /**
      * @brief Bind buffers to shader binding points
      * @param weightsBinding Binding point for weights SSBO
      * @param biasesBinding Binding point for biases SSBO
      * @param activationsBinding Binding point for activations SSBO
+     * @param topKBinding Binding point for the top-k result SSBO (if enabled)
      */
     void bindBuffers(GLuint weightsBinding = 0,
                      GLuint biasesBinding = 1,
-                     GLuint activationsBinding = 2) const;
+                     GLuint activationsBinding = 2,
+                     GLuint topKBinding = 3) const;
+
+    /**
+     * @brief Set the host memory that streamed weights are read from
+     *
+     * Streaming mode only. The pointer must stay valid (e.g. a mapped ModelFile)
+     * for as long as the buffers are used.
+     * @param weights Flat array of all weights (computeOffsets order)
+     * @param count Number of floats (must equal total weight count)
+     */
+    void setStreamingSource(const float* weights, size_t count);
+
+    /**
+     * @brief Bind the weights shard (or streaming slot) holding one layer
+     *
+     * In streaming mode this makes the layer resident first, staging it from the
+     * streaming source if needed. LayerInfo::weightOffset is relative to the bound buffer.
+     */
+    void bindLayerWeights(size_t layerIndex, GLuint binding);
+
+    /**
+     * @brief Start copying a layer's weights into a free slot (streaming mode only)
+     *
+     * Call right after dispatching the previous layer: the host-side staging copy
+     * overlaps with the GPU work, and the slot upload is queued behind it.
+     */
+    void prefetchLayer(size_t layerIndex);
+
+    /**
+     * @brief Mark a layer's output (and so every later layer) as stale
+     *
+     * Called by every setter that changes inputs, activations or parameters.
+     */
+    void markLayerDirty(size_t layerIndex) {
+        m_firstDirtyLayer = std::min(m_firstDirtyLayer, layerIndex);
+        if (layerIndex == 0) m_preActivationsValid = false;
+    }
+
+    /**
+     * @brief Counter bumped by every change to weights, biases or folded parameters
+     *
+     * Results computed under one version are valid until it changes (InferenceCache key).
+     */
+    uint64_t getWeightsVersion() const { return m_weightsVersion; }
+
+    /**
+     * @brief Record that a layer was dispatched; clean if its input was up to date
+     */
+    void markLayerComputed(size_t layerIndex) {
+        if (layerIndex == m_firstDirtyLayer) m_firstDirtyLayer++;
+        if (layerIndex == 0) m_preActivationsValid = supportsInputDeltas();
+    }
+
+    /**
+     * @brief First layer whose output is stale (layer count if all are current)
+     *
+     * Always 0 with reuseActivations: upstream activations are not kept between passes.
+     */
+    size_t getFirstDirtyLayer() const { return m_config.reuseActivations ? 0 : m_firstDirtyLayer; }
+
+    /**
+     * @brief Number of layers the next incremental forward pass has to dispatch
+     */
+    size_t getDirtyLayerCount() const { return m_layerInfo.size() - std::min(getFirstDirtyLayer(), m_layerInfo.size()); }
+
+    /**
+     * @brief Check whether weights are streamed instead of fully resident
+     */
+    bool isStreaming() const { return m_config.streamWeights; }
 
     /**
      * @brief Get layer metadata for uploading to uniform buffer
@@ -112,24 +620,154 @@ public:
      */
     uint32_t getTotalNeuronCount() const { return m_totalNeurons; }
 
+    /**
+     * @brief Get total number of weights across all layers (may exceed 32 bits)
+     */
+    uint64_t getTotalWeightCount() const { return m_totalWeights; }
+
+    /**
+     * @brief Get total number of biases across all layers
+     */
+    uint64_t getTotalBiasCount() const { return m_totalBiases; }
+
+    /**
+     * @brief Get offset (in floats) of a layer's weights in the flat uploadWeights() array
+     */
+    uint64_t getLayerWeightStart(size_t layerIndex) const { return m_layerWeightStart[layerIndex]; }
+
+    /**
+     * @brief Get number of weights of a layer in the flat uploadWeights() array
+     */
+    uint64_t getLayerWeightCount(size_t layerIndex) const;
+
+    /**
+     * @brief Get feature map shape of each topology layer (input first)
+     */
+    const std::vector<TensorShape>& getLayerShapes() const { return m_layerShapes; }
+
+    /**
+     * @brief Get the layer descriptors the buffers were built from
+     */
+    const std::vector<LayerDesc>& getLayerDescs() const { return m_layerDescs; }
+
+    /**
+     * @brief Get number of weights SSBO shards
+     */
+    size_t getWeightShardCount() const { return m_weightShards.size(); }
+
+    /**
+     * @brief Get offset of each topology layer's first neuron in the activations SSBO
+     *
+     * Equals the running sum of layer sizes unless padToVec4 is set.
+     */
+    const std::vector<uint32_t>& getActivationOffsets() const { return m_activationOffsets; }
+
     /**
      * @brief Get network topology (layer sizes)
      */
     const std::vector<uint32_t>& getTopology() const { return m_topology; }
 
 private:
-    GLuint m_weightsSSBO = 0;
+    // Weights are split across one or more SSBOs, each holding whole layers
+    struct WeightShard {
+        GLuint buffer = 0;
+        void* mapped = nullptr;        // Persistent mapping (UploadStrategy::PersistentMap only)
+        uint64_t globalOffset = 0;     // First weight of the shard in the flat array (floats)
+        uint64_t size = 0;             // In floats
+    };
+    std::vector<WeightShard> m_weightShards;
+
     GLuint m_biasesSSBO = 0;
     GLuint m_activationsSSBO = 0;
+    GLuint m_topKSSBO = 0;             // Fused top-k output (Config::topK entries)
+    GLuint m_preActivationSSBO = 0;    // Layer 0 pre-activations (input deltas only)
+    GLuint m_sparseInputSSBO = 0;      // Config::maxActiveInputs SparseInput entries
+    void* m_sparseInputMapped = nullptr;
+    uint32_t m_sparseInputCount = 0;
+    bool m_sparseInputActive = false;  // False after a dense fallback upload
+    GLuint m_inputDeltaSSBO = 0;       // MAX_INPUT_DELTAS InputDelta entries
+    void* m_inputDeltaMapped = nullptr;
+
+    // Persistent mappings (UploadStrategy::PersistentMap only)
+    void* m_biasesMapped = nullptr;
+    void* m_activationsMapped = nullptr;
+
+    // Streaming mode: a ring of per-layer weight slots fed from two staging buffers
+    struct WeightSlot {
+        GLuint buffer = 0;
+        int64_t layer = -1;        // Resident layer, -1 if empty
+        uint64_t lastUse = 0;
+    };
+    std::vector<WeightSlot> m_weightSlots;
+    GLuint m_stagingBuffers[2] = {0, 0};
+    void* m_stagingMapped[2] = {nullptr, nullptr};
+    GLsync m_stagingFences[2] = {nullptr, nullptr};
+    uint32_t m_nextStaging = 0;
+    uint64_t m_slotUseCounter = 0;
+    const float* m_streamingSource = nullptr;
+
+    Config m_config;
 
     std::vector<uint32_t> m_topology;       // Layer sizes (e.g., {2, 2, 1})
+    std::vector<TensorShape> m_layerShapes; // Feature map shape per topology layer
+    std::vector<LayerDesc> m_layerDescs;    // Per computed layer
+    std::vector<Precision> m_layerPrecision;    // Per computed layer, resolved from Config
     std::vector<LayerInfo> m_layerInfo;     // Per-layer metadata
 
-    uint32_t m_totalWeights = 0;
-    uint32_t m_totalBiases = 0;
+    std::vector<uint64_t> m_layerWeightStart;   // Per-layer offset into the flat weights array
+    std::vector<uint32_t> m_activationOffsets;  // Per-topology-layer offset into the activations SSBO
+    uint32_t m_activationBufferSize = 0;        // In floats, including vec4 padding
+
+    uint64_t m_totalWeights = 0;
+    uint64_t m_totalBiases = 0;
     uint32_t m_totalNeurons = 0;
+    uint64_t m_maxLayerWeights = 0;
+    uint64_t m_maxShardBytes = 0;               // Effective shard limit for this topology
+
+    // Load-time folding: canonical y = act(bnScale * (W x_norm + b) + bnShift) with
+    // x_norm = (x - inputMean) * inputScale becomes y = act(W' x + b')
+    std::vector<std::vector<float>> m_bnScale;  // Per layer, per output channel; empty = no batch norm
+    std::vector<std::vector<float>> m_bnShift;
+    std::vector<float> m_inputMean;             // Per input channel; empty = no input normalization
+    std::vector<float> m_inputScale;            // 1 / stddev
+    std::vector<float> m_inputBiasShift;        // Per layer 0 output: -sum(W * mean * scale)
+    std::vector<float> m_hostBiases;            // Unfolded biases, re-folded when weights change
+    std::vector<float> m_hostWeights;           // Row-major shadow for setWeight(), read back on the first edit
+    bool m_weightsUploaded = false;
+    std::map<uint64_t, uint64_t> m_dirtyWeights;    // Disjoint [begin, end) flat intervals
+    std::map<uint64_t, uint64_t> m_dirtyBiases;
+    size_t m_firstDirtyLayer = 0;               // Layers before it hold current activations
+    uint64_t m_weightsVersion = 0;
+    bool m_preActivationsValid = false;         // Layer 0 pre-activations match the current inputs
+    std::vector<float> m_hostInputs;            // Inputs the GPU holds (before pending deltas)
+    std::map<uint32_t, float> m_pendingInputs;  // Input index -> new value
+    std::vector<float> m_foldScratch;
 
-    void computeOffsets();
+    bool computeOffsets();
+    void uploadWeightStorage(uint64_t offset, uint64_t count, const float* weights);
+    bool coversWholeLayers(uint64_t offset, uint64_t count) const;
+    static void markDirty(std::map<uint64_t, uint64_t>& dirty, uint64_t begin, uint64_t end);
+    uint64_t planActivationArena(const std::vector<uint64_t>& sizes, std::vector<uint64_t>& offsets) const;
+    uint64_t layerStorageSize(const LayerInfo& info) const;
+    uint32_t inputStride(const LayerInfo& info) const;
+    void foldChannels(const LayerInfo& info, uint64_t weight, uint64_t& outChannel, uint64_t& inChannel) const;
+    const float* foldLayerWeights(size_t layerIndex, const float* canonical);
+    void scaleFoldedWeights(size_t layerIndex, float* weights) const;
+    void uploadFoldedBiases();
+    void packLayerWeights(const LayerInfo& info, const float* rowMajor, float* storage) const;
+    void unpackLayerWeights(const LayerInfo& info, const float* storage, float* rowMajor) const;
+    void packReducedPrecision(const LayerInfo& info, const float* rowMajor, float* storage) const;
+    void unpackReducedPrecision(const LayerInfo& info, const float* storage, float* rowMajor) const;
+    void packBinaryWeights(const LayerInfo& info, const float* rowMajor, float* storage) const;
+    void unpackBinaryWeights(const LayerInfo& info, const float* storage, float* rowMajor) const;
+    void packLowRankWeights(const LayerInfo& info, const float* canonical, float* storage) const;
+    void unpackLowRankWeights(const LayerInfo& info, const float* storage, float* canonical) const;
     void createBuffers();
+    GLuint createBuffer(GLsizeiptr size, void** mappedOut);
+    void uploadRange(GLuint buffer, void* mapped, GLsizeiptr bufferSize,
+                     GLintptr offset, GLsizeiptr size, const void* data);
+    void createStreamingBuffers();
+    int findResidentSlot(size_t layerIndex) const;
+    int stageLayer(size_t layerIndex);
     void cleanup();
 };
\ No newline at end of file
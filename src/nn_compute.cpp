@@ -1,5 +1,6 @@
 #include "nn_compute.h"
 #include "shader_loader.h"
+#include <algorithm>
 #include <iostream>
 
 NeuralCompute::~NeuralCompute() {
@@ -16,6 +17,54 @@ bool NeuralCompute::initialize(const std::string& computeShaderPath, NeuralBuffe
         return false;
     }
 
+    // Convolution and pooling kernels live next to forward.comp
+    bool hasConv = false, hasPool = false, hasBinary = false, hasLowRank = false;
+    for (const auto& desc : buffers.getLayerDescs()) {
+        hasConv = hasConv || desc.kind == LayerKind::Conv2D;
+        hasPool = hasPool || desc.isPooling();
+        hasBinary = hasBinary || desc.kind == LayerKind::BinaryDense;
+        hasLowRank = hasLowRank || desc.kind == LayerKind::LowRankDense;
+    }
+    const std::string shaderDir = computeShaderPath.substr(0, computeShaderPath.find_last_of("/\\") + 1);
+    if (hasConv) {
+        m_convProgram = ShaderLoader::loadComputeShader(shaderDir + "conv2d.comp");
+        if (m_convProgram == 0) {
+            std::cerr << "[ERROR] Failed to load compute shader: " << shaderDir << "conv2d.comp\n";
+            return false;
+        }
+    }
+    if (hasPool) {
+        m_poolProgram = ShaderLoader::loadComputeShader(shaderDir + "pool2d.comp");
+        if (m_poolProgram == 0) {
+            std::cerr << "[ERROR] Failed to load compute shader: " << shaderDir << "pool2d.comp\n";
+            return false;
+        }
+    }
+
+    if (hasBinary) {
+        m_binaryProgram = ShaderLoader::loadComputeShader(shaderDir + "binary_dense.comp");
+        if (m_binaryProgram == 0) {
+            std::cerr << "[ERROR] Failed to load compute shader: " << shaderDir << "binary_dense.comp\n";
+            return false;
+        }
+    }
+
+    if (hasLowRank) {
+        m_lowRankProgram = ShaderLoader::loadComputeShader(shaderDir + "low_rank_dense.comp");
+        if (m_lowRankProgram == 0) {
+            std::cerr << "[ERROR] Failed to load compute shader: " << shaderDir << "low_rank_dense.comp\n";
+            return false;
+        }
+    }
+
+    if (buffers.supportsInputDeltas()) {
+        m_inputDeltaProgram = ShaderLoader::loadComputeShader(shaderDir + "input_delta.comp");
+        if (m_inputDeltaProgram == 0) {
+            std::cerr << "[ERROR] Failed to load compute shader: " << shaderDir << "input_delta.comp\n";
+            return false;
+        }
+    }
+
     // Create uniform buffer for layer info
     glGenBuffers(1, &m_layerInfoUBO);
     uploadLayerInfo();
@@ -30,6 +79,61 @@ bool NeuralCompute::initialize(const std::string& computeShaderPath, NeuralBuffe
 }
 
 void NeuralCompute::forward() {
+    dispatchLayers(0);
+}
+
+size_t NeuralCompute::forwardIncremental() {
+    if (!m_buffers) {
+        std::cerr << "[ERROR] NeuralCompute not initialized\n";
+        return 0;
+    }
+
+    // Edits mark their layers dirty when they are made; dispatchLayers() flushes them
+    const size_t first = m_buffers->getFirstDirtyLayer();
+    if (first >= m_buffers->getLayerInfo().size() && !m_buffers->hasPendingInputDeltas()) {
+        m_lastDispatchedLayers = 0;
+        return 0;
+    }
+    dispatchLayers(first);
+    return m_lastDispatchedLayers;
+}
+
+void NeuralCompute::infer(const std::vector<float>& inputs, std::vector<float>& outputs) {
+    if (!m_buffers) {
+        std::cerr << "[ERROR] NeuralCompute not initialized\n";
+        return;
+    }
+
+    // A wrong-sized input would leave the previous inputs on the GPU: never run or cache it
+    if (inputs.size() != m_buffers->getTopology()[0]) {
+        std::cerr << "[ERROR] Input size mismatch. Expected "
+                  << m_buffers->getTopology()[0] << ", got " << inputs.size() << "\n";
+        outputs.clear();
+        return;
+    }
+
+    const uint64_t version = m_buffers->getWeightsVersion();
+    if (m_cache) {
+        // Entries from older weights can never hit again: free their memory
+        if (version != m_cacheWeightsVersion) {
+            m_cache->clear();
+            m_cacheWeightsVersion = version;
+        }
+        if (m_cache->lookup(inputs, version, outputs)) {
+            return;
+        }
+    }
+
+    m_buffers->setInputs(inputs);
+    forward();
+    m_buffers->readOutputs(outputs);
+
+    if (m_cache) {
+        m_cache->insert(inputs, version, outputs);
+    }
+}
+
+void NeuralCompute::dispatchLayers(size_t firstLayer) {
     if (!m_buffers || m_computeProgram == 0) {
         std::cerr << "[ERROR] NeuralCompute not initialized\n";
         return;
@@ -37,10 +141,41 @@ void NeuralCompute::forward() {
 
     const auto& layerInfo = m_buffers->getLayerInfo();
 
+    // Live edits made since the last pass, coalesced into as few uploads as possible
+    m_buffers->flushDirtyRanges();
+
+    if (m_profilingEnabled && m_timerQuery) {
+        glBeginQuery(GL_TIME_ELAPSED, m_timerQuery);
+    }
+
+    // Changed inputs first: writes them and, if layer 0 is clean, brings it up to date
+    if (m_buffers->hasPendingInputDeltas()) {
+        dispatchInputDeltas();
+    }
+
     // Dispatch compute shader for each layer
-    for (size_t i = 0; i < layerInfo.size(); ++i) {
+    for (size_t i = firstLayer; i < layerInfo.size(); ++i) {
         forwardLayer(i);
     }
+    m_lastDispatchedLayers = layerInfo.size() - std::min(firstLayer, layerInfo.size());
+
+    if (m_profilingEnabled && m_timerQuery) {
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // Blocks until the GPU has finished the pass
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(m_timerQuery, GL_QUERY_RESULT, &elapsedNs);
+        m_lastExecutionTimeMs = static_cast<float>(elapsedNs) / 1.0e6f;
+    }
+}
+
+void NeuralCompute::setProfilingEnabled(bool enabled) {
+    m_profilingEnabled = enabled;
+
+    // Create the query lazily so profiling can be toggled after initialize()
+    if (m_profilingEnabled && m_timerQuery == 0 && m_computeProgram != 0) {
+        glGenQueries(1, &m_timerQuery);
+    }
 }
 
 void NeuralCompute::forwardLayer(size_t layerIndex) {
@@ -55,6 +190,24 @@ void NeuralCompute::forwardLayer(size_t layerIndex) {
         std::cerr << "[ERROR] Layer index out of bounds: " << layerIndex << "\n";
         return;
     }
+    m_buffers->markLayerComputed(layerIndex);
+
+    if (layerInfo[layerIndex].layerKind == static_cast<uint32_t>(LayerKind::Conv2D)) {
+        dispatchConvLayer(layerIndex);
+        return;
+    }
+    if (m_buffers->getLayerDescs()[layerIndex].isPooling()) {
+        dispatchPoolLayer(layerIndex);
+        return;
+    }
+    if (layerInfo[layerIndex].layerKind == static_cast<uint32_t>(LayerKind::BinaryDense)) {
+        dispatchOutputLayer(m_binaryProgram, layerIndex);
+        return;
+    }
+    if (layerInfo[layerIndex].layerKind == static_cast<uint32_t>(LayerKind::LowRankDense)) {
+        dispatchOutputLayer(m_lowRankProgram, layerIndex);
+        return;
+    }
 
     // Bind shader program
     glUseProgram(m_computeProgram);
@@ -62,6 +215,9 @@ void NeuralCompute::forwardLayer(size_t layerIndex) {
     // Bind buffers
     m_buffers->bindBuffers(0, 1, 2);
 
+    // Weights live in the layer's shard (or streaming slot), not one monolithic SSBO
+    m_buffers->bindLayerWeights(layerIndex, 0);
+
     // Bind UBO with layer info
     glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_layerInfoUBO);
 
@@ -69,16 +225,144 @@ void NeuralCompute::forwardLayer(size_t layerIndex) {
     GLint layerLoc = glGetUniformLocation(m_computeProgram, "u_layerIndex");
     glUniform1ui(layerLoc, static_cast<GLuint>(layerIndex));
 
+    // Weight storage layout (row-major, input-major or tiled)
+    GLint layoutLoc = glGetUniformLocation(m_computeProgram, "u_weightLayout");
+    glUniform1ui(layoutLoc, static_cast<GLuint>(m_buffers->getConfig().weightLayout));
+
+    // vec4 loads are only valid when strides and offsets are padded to multiples of 4
+    GLint vec4Loc = glGetUniformLocation(m_computeProgram, "u_vec4Loads");
+    glUniform1ui(vec4Loc, m_buffers->getConfig().padToVec4 ? 1u : 0u);
+
+    // Fused top-k is written by the output layer only
+    bool isOutputLayer = (layerIndex + 1 == layerInfo.size());
+    GLint topKLoc = glGetUniformLocation(m_computeProgram, "u_topK");
+    glUniform1ui(topKLoc, (isOutputLayer && m_buffers->hasTopK()) ? m_buffers->getConfig().topK : 0u);
+
+    // Layer 0 keeps its pre-activations for sparse input updates
+    const bool storePreActivation = layerIndex == 0 && m_buffers->supportsInputDeltas();
+    if (storePreActivation) {
+        m_buffers->bindPreActivations(4);
+    }
+    GLint storeLoc = glGetUniformLocation(m_computeProgram, "u_storePreActivation");
+    glUniform1ui(storeLoc, storePreActivation ? 1u : 0u);
+
+    // Sparse input mode: layer 0 gathers the active inputs' weight columns
+    const bool sparseInput = layerIndex == 0 && m_buffers->isSparseInputActive();
+    if (sparseInput) {
+        m_buffers->bindSparseInputs(6);
+    }
+    glUniform1ui(glGetUniformLocation(m_computeProgram, "u_sparseInput"), sparseInput ? 1u : 0u);
+    glUniform1ui(glGetUniformLocation(m_computeProgram, "u_sparseInputCount"),
+                 sparseInput ? m_buffers->getSparseInputCount() : 0u);
+
     // Calculate work groups (1D dispatch)
     uint32_t outputSize = layerInfo[layerIndex].outputSize;
     uint32_t workGroupSize = 256;  // Must match shader local_size_x
     uint32_t workGroups = (outputSize + workGroupSize - 1) / workGroupSize;
 
+    // Softmax reduces over the whole layer in shared memory: one workgroup loops over all outputs
+    if (layerInfo[layerIndex].activationType == static_cast<uint32_t>(NeuralBuffers::Activation::Softmax)) {
+        workGroups = 1;
+    }
+
     // Dispatch
     glDispatchCompute(workGroups, 1, 1);
 
     // Memory barrier - critical!
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Streaming: stage the next layer's weights while this one executes
+    m_buffers->prefetchLayer((layerIndex + 1) % layerInfo.size());
+}
+
+void NeuralCompute::dispatchConvLayer(size_t layerIndex) {
+    const auto& layerInfo = m_buffers->getLayerInfo();
+    const auto& info = layerInfo[layerIndex];
+
+    glUseProgram(m_convProgram);
+
+    m_buffers->bindBuffers(0, 1, 2);
+    m_buffers->bindLayerWeights(layerIndex, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_layerInfoUBO);
+
+    GLint layerLoc = glGetUniformLocation(m_convProgram, "u_layerIndex");
+    glUniform1ui(layerLoc, static_cast<GLuint>(layerIndex));
+
+    // One workgroup per CONV_TILE x CONV_TILE output tile per output channel
+    const uint32_t tile = NeuralBuffers::CONV_TILE;
+    glDispatchCompute((info.outputWidth + tile - 1) / tile,
+                      (info.outputHeight + tile - 1) / tile,
+                      info.outputChannels);
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_buffers->prefetchLayer((layerIndex + 1) % layerInfo.size());
+}
+
+void NeuralCompute::dispatchPoolLayer(size_t layerIndex) {
+    const auto& layerInfo = m_buffers->getLayerInfo();
+
+    glUseProgram(m_poolProgram);
+
+    // Pooling reads and writes activations only
+    m_buffers->bindBuffers(0, 1, 2);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_layerInfoUBO);
+
+    GLint layerLoc = glGetUniformLocation(m_poolProgram, "u_layerIndex");
+    glUniform1ui(layerLoc, static_cast<GLuint>(layerIndex));
+
+    uint32_t workGroupSize = 256;  // Must match shader local_size_x
+    glDispatchCompute((layerInfo[layerIndex].outputSize + workGroupSize - 1) / workGroupSize, 1, 1);
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_buffers->prefetchLayer((layerIndex + 1) % layerInfo.size());
+}
+
+void NeuralCompute::dispatchOutputLayer(GLuint program, size_t layerIndex) {
+    const auto& layerInfo = m_buffers->getLayerInfo();
+
+    glUseProgram(program);
+
+    m_buffers->bindBuffers(0, 1, 2);
+    m_buffers->bindLayerWeights(layerIndex, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_layerInfoUBO);
+
+    GLint layerLoc = glGetUniformLocation(program, "u_layerIndex");
+    glUniform1ui(layerLoc, static_cast<GLuint>(layerIndex));
+
+    // One thread per output; every workgroup prepares its shared input (bits, bottleneck) itself
+    uint32_t workGroupSize = 256;  // Must match shader local_size_x
+    glDispatchCompute((layerInfo[layerIndex].outputSize + workGroupSize - 1) / workGroupSize, 1, 1);
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_buffers->prefetchLayer((layerIndex + 1) % layerInfo.size());
+}
+
+void NeuralCompute::dispatchInputDeltas() {
+    const auto& layerInfo = m_buffers->getLayerInfo();
+
+    glUseProgram(m_inputDeltaProgram);
+
+    // Reads layer 0's weight columns for the changed inputs only
+    m_buffers->bindBuffers(0, 1, 2);
+    m_buffers->bindLayerWeights(0, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_layerInfoUBO);
+    const uint32_t deltaCount = m_buffers->bindInputDeltas(4, 5);
+
+    glUniform1ui(glGetUniformLocation(m_inputDeltaProgram, "u_deltaCount"), deltaCount);
+    glUniform1ui(glGetUniformLocation(m_inputDeltaProgram, "u_weightLayout"),
+                 static_cast<GLuint>(m_buffers->getConfig().weightLayout));
+    glUniform1ui(glGetUniformLocation(m_inputDeltaProgram, "u_vec4Loads"),
+                 m_buffers->getConfig().padToVec4 ? 1u : 0u);
+
+    // One thread per layer 0 output (and per delta, for the input writes)
+    uint32_t workGroupSize = 256;  // Must match shader local_size_x
+    uint32_t threads = std::max(layerInfo[0].outputSize, deltaCount);
+    glDispatchCompute((threads + workGroupSize - 1) / workGroupSize, 1, 1);
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 }
 
 size_t NeuralCompute::getLayerCount() const {
@@ -105,6 +389,26 @@ void NeuralCompute::cleanup() {
         glDeleteProgram(m_computeProgram);
         m_computeProgram = 0;
     }
+    if (m_convProgram) {
+        glDeleteProgram(m_convProgram);
+        m_convProgram = 0;
+    }
+    if (m_poolProgram) {
+        glDeleteProgram(m_poolProgram);
+        m_poolProgram = 0;
+    }
+    if (m_binaryProgram) {
+        glDeleteProgram(m_binaryProgram);
+        m_binaryProgram = 0;
+    }
+    if (m_lowRankProgram) {
+        glDeleteProgram(m_lowRankProgram);
+        m_lowRankProgram = 0;
+    }
+    if (m_inputDeltaProgram) {
+        glDeleteProgram(m_inputDeltaProgram);
+        m_inputDeltaProgram = 0;
+    }
     if (m_layerInfoUBO) {
         glDeleteBuffers(1, &m_layerInfoUBO);
         m_layerInfoUBO = 0;
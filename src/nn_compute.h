@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nn_buffers.h"
+#include "inference_cache.h"
 #include <glad/glad.h>
 #include <vector>
 #include <string>
@@ -28,6 +29,9 @@ public:
      * @param computeShaderPath Path to forward pass compute shader
      * @param buffers Reference to neural network buffers
      * @return true if initialization successful
+     *
+     * Networks with convolution, pooling, binary or low-rank layers also load conv2d.comp /
+     * pool2d.comp / binary_dense.comp / low_rank_dense.comp from the same directory.
      */
     bool initialize(const std::string& computeShaderPath, NeuralBuffers& buffers);
 
@@ -36,9 +40,41 @@ public:
      *
      * Dispatches compute shader for each layer sequentially
      * Inserts memory barriers between layers
+     * (a layer is one fused group when the network comes from LayerGraph)
      */
     void forward();
 
+    /**
+     * @brief Re-dispatch only the layers downstream of the first dirty one
+     * @return Number of layers dispatched (0 if every activation is current)
+     *
+     * Starts at NeuralBuffers::getFirstDirtyLayer() and reuses the cached activations
+     * upstream of it, so an edit near the output of a deep network costs a few dispatches.
+     * forward() always recomputes every layer.
+     */
+    size_t forwardIncremental();
+
+    /**
+     * @brief Full request path: setInputs, forward, readOutputs - through the cache if set
+     * @param inputs Input values
+     * @param outputs Output layer values
+     *
+     * A cache hit (same input bytes, same NeuralBuffers::getWeightsVersion()) returns the
+     * stored outputs without touching the GPU. An input of the wrong size is rejected
+     * (outputs cleared) before the cache is consulted.
+     */
+    void infer(const std::vector<float>& inputs, std::vector<float>& outputs);
+
+    /**
+     * @brief Put a result cache in front of infer() (nullptr to disable; not owned)
+     */
+    void setCache(InferenceCache* cache) { m_cache = cache; }
+
+    /**
+     * @brief Layers dispatched by the last forward()/forwardIncremental() (for UI display)
+     */
+    size_t getLastDispatchedLayerCount() const { return m_lastDispatchedLayers; }
+
     /**
      * @brief Execute forward pass for a single layer
      * @param layerIndex Index of the layer to compute (0-based)
@@ -52,23 +88,39 @@ public:
 
     /**
      * @brief Get last recorded GPU execution time in milliseconds
+     *
+     * Measured around the whole forward() call with a GL_TIME_ELAPSED query.
+     * Only updated while profiling is enabled.
      */
     float getLastExecutionTime() const { return m_lastExecutionTimeMs; }
 
     /**
      * @brief Enable/disable GPU profiling with timer queries
      */
-    void setProfilingEnabled(bool enabled) { m_profilingEnabled = enabled; }
+    void setProfilingEnabled(bool enabled);
 
 private:
     GLuint m_computeProgram = 0;
+    GLuint m_convProgram = 0;           // Tiled direct convolution (only if the network has conv layers)
+    GLuint m_poolProgram = 0;           // Max/avg pooling (only if the network has pooling layers)
+    GLuint m_binaryProgram = 0;         // XNOR-popcount dense (only if the network has binary layers)
+    GLuint m_lowRankProgram = 0;        // Fused U * (V * x) (only if the network has low-rank layers)
+    GLuint m_inputDeltaProgram = 0;     // Sparse first-layer update (only if the buffers support it)
     GLuint m_layerInfoUBO = 0;          // Uniform buffer for layer metadata
     GLuint m_timerQuery = 0;            // GPU timer query for profiling
 
     NeuralBuffers* m_buffers = nullptr;
     bool m_profilingEnabled = false;
     float m_lastExecutionTimeMs = 0.0f;
+    size_t m_lastDispatchedLayers = 0;
+    InferenceCache* m_cache = nullptr;
+    uint64_t m_cacheWeightsVersion = 0;     // Version the cached entries were computed under
 
     void uploadLayerInfo();
+    void dispatchLayers(size_t firstLayer);
+    void dispatchInputDeltas();
+    void dispatchConvLayer(size_t layerIndex);
+    void dispatchPoolLayer(size_t layerIndex);
+    void dispatchOutputLayer(GLuint program, size_t layerIndex);    // Binary / low-rank: thread per output
     void cleanup();
 };
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "quantized_network.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if (defined(__AVX512VNNI__) && defined(__AVX512F__)) || defined(__AVXVNNI__)
+#include <immintrin.h>
+#endif
+
+namespace {
+constexpr uint32_t kSoftmax = 4;    // NeuralBuffers::Activation::Softmax
+constexpr int32_t kZeroPoint = 128; // u8 activation = s8 value + 128
+
+#if (defined(__AVX512VNNI__) && defined(__AVX512F__)) || defined(__AVXVNNI__)
+int32_t horizontalSum(__m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+}
+
+bool QuantizedNetwork::initialize(const std::vector<uint32_t>& layerSizes,
+                                  const std::vector<uint32_t>& activations) {
+    if (!m_reference.initialize(layerSizes, activations)) {
+        return false;
+    }
+
+    m_topology = layerSizes;
+    m_layers.assign(layerSizes.size() - 1, Layer{});
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        Layer& layer = m_layers[i];
+        layer.inputSize = layerSizes[i];
+        layer.outputSize = layerSizes[i + 1];
+        layer.rowStride = (layer.inputSize + ROW_ALIGN - 1) / ROW_ALIGN * ROW_ALIGN;
+        layer.activation = activations[i];
+    }
+
+    m_weights.clear();
+    m_biases.clear();
+    m_calibrated = false;
+    return true;
+}
+
+bool QuantizedNetwork::setWeights(const std::vector<float>& weights) {
+    if (!m_reference.setWeights(weights)) {
+        return false;
+    }
+    m_weights = weights;
+    m_calibrated = false;
+    return true;
+}
+
+bool QuantizedNetwork::setBiases(const std::vector<float>& biases) {
+    if (!m_reference.setBiases(biases)) {
+        return false;
+    }
+    m_biases = biases;
+    return true;
+}
+
+bool QuantizedNetwork::calibrate(const std::vector<std::vector<float>>& samples) {
+    if (m_layers.empty() || m_weights.empty() || m_biases.empty()) {
+        std::cerr << "[ERROR] QuantizedNetwork: set weights and biases before calibrating\n";
+        return false;
+    }
+    if (samples.empty()) {
+        std::cerr << "[ERROR] QuantizedNetwork: calibration needs at least one sample\n";
+        return false;
+    }
+
+    // Largest |activation| per topology layer over the sample set
+    std::vector<float> maxAbs(m_topology.size(), 0.0f);
+    std::vector<float> outputs;
+    for (const auto& sample : samples) {
+        if (sample.size() != m_topology[0]) {
+            std::cerr << "[ERROR] QuantizedNetwork: calibration sample size mismatch. Expected "
+                      << m_topology[0] << ", got " << sample.size() << "\n";
+            return false;
+        }
+        m_reference.forward(sample, outputs);
+        const std::vector<float>& all = m_reference.getAllActivations();
+        size_t offset = 0;
+        for (size_t l = 0; l < m_topology.size(); ++l) {
+            for (uint32_t n = 0; n < m_topology[l]; ++n) {
+                maxAbs[l] = std::max(maxAbs[l], std::fabs(all[offset + n]));
+            }
+            offset += m_topology[l];
+        }
+    }
+
+    size_t weightOffset = 0;
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        Layer& layer = m_layers[i];
+        layer.inputScale = maxAbs[i] > 0.0f ? maxAbs[i] / 127.0f : 1.0f;
+
+        layer.weights.assign(static_cast<size_t>(layer.outputSize) * layer.rowStride, 0);
+        layer.weightScales.assign(layer.outputSize, 1.0f);
+        layer.rowSums.assign(layer.outputSize, 0);
+
+        for (uint32_t o = 0; o < layer.outputSize; ++o) {
+            const float* row = m_weights.data() + weightOffset + static_cast<size_t>(o) * layer.inputSize;
+            float rowMax = 0.0f;
+            for (uint32_t n = 0; n < layer.inputSize; ++n) {
+                rowMax = std::max(rowMax, std::fabs(row[n]));
+            }
+            const float scale = rowMax > 0.0f ? rowMax / 127.0f : 1.0f;
+
+            int8_t* quantized = layer.weights.data() + static_cast<size_t>(o) * layer.rowStride;
+            int32_t sum = 0;
+            for (uint32_t n = 0; n < layer.inputSize; ++n) {
+                const long q = std::lround(row[n] / scale);
+                quantized[n] = static_cast<int8_t>(std::clamp(q, -127L, 127L));
+                sum += quantized[n];
+            }
+            layer.weightScales[o] = scale;
+            layer.rowSums[o] = sum;
+        }
+        weightOffset += static_cast<size_t>(layer.inputSize) * layer.outputSize;
+    }
+
+    m_calibrated = true;
+    std::cout << "[INFO] QuantizedNetwork: calibrated on " << samples.size()
+              << " samples (" << kernelName() << " kernel)\n";
+    return true;
+}
+
+void QuantizedNetwork::forward(const std::vector<float>& inputs, std::vector<float>& outputs) {
+    if (!m_calibrated) {
+        std::cerr << "[ERROR] QuantizedNetwork: forward() before calibrate()\n";
+        return;
+    }
+    if (inputs.size() != m_topology[0]) {
+        std::cerr << "[ERROR] QuantizedNetwork: input size mismatch. Expected "
+                  << m_topology[0] << ", got " << inputs.size() << "\n";
+        return;
+    }
+
+    quantizeActivations(inputs.data(), m_layers[0].inputSize, m_layers[0].inputScale, m_layers[0].rowStride, m_input);
+
+    size_t biasOffset = 0;
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        const Layer& layer = m_layers[i];
+        m_values.resize(layer.outputSize);
+
+        for (uint32_t o = 0; o < layer.outputSize; ++o) {
+            const int8_t* row = layer.weights.data() + static_cast<size_t>(o) * layer.rowStride;
+            const int32_t acc = dot(m_input.data(), row, layer.rowStride) - kZeroPoint * layer.rowSums[o];
+            const float sum = static_cast<float>(acc) * layer.inputScale * layer.weightScales[o] +
+                              m_biases[biasOffset + o];
+            m_values[o] = CpuReference::applyActivation(sum, layer.activation);
+        }
+        if (layer.activation == kSoftmax) {
+            CpuReference::applySoftmax(m_values.data(), layer.outputSize);
+        }
+
+        if (i + 1 < m_layers.size()) {
+            const Layer& next = m_layers[i + 1];
+            quantizeActivations(m_values.data(), layer.outputSize, next.inputScale, next.rowStride, m_next);
+            std::swap(m_input, m_next);
+        }
+        biasOffset += layer.outputSize;
+    }
+
+    outputs.assign(m_values.begin(), m_values.end());
+}
+
+const char* QuantizedNetwork::kernelName() {
+#if defined(__AVX512VNNI__) && defined(__AVX512F__)
+    return "avx512-vnni";
+#elif defined(__AVXVNNI__)
+    return "avx-vnni";
+#else
+    return "portable";
+#endif
+}
+
+void QuantizedNetwork::quantizeActivations(const float* values, uint32_t count, float scale,
+                                           uint32_t stride, std::vector<uint8_t>& out) const {
+    // Padding holds the zero point; its weights are zero, so the value never matters
+    out.assign(stride, static_cast<uint8_t>(kZeroPoint));
+    const float inverse = 1.0f / scale;
+    for (uint32_t i = 0; i < count; ++i) {
+        const long q = std::clamp(std::lround(values[i] * inverse), -127L, 127L);
+        out[i] = static_cast<uint8_t>(q + kZeroPoint);
+    }
+}
+
+int32_t QuantizedNetwork::dot(const uint8_t* activations, const int8_t* weights, uint32_t count) {
+    // count is a multiple of ROW_ALIGN
+#if defined(__AVX512VNNI__) && defined(__AVX512F__)
+    __m512i acc = _mm512_setzero_si512();
+    for (uint32_t i = 0; i < count; i += 64) {
+        const __m512i a = _mm512_loadu_si512(activations + i);
+        const __m512i w = _mm512_loadu_si512(weights + i);
+        acc = _mm512_dpbusd_epi32(acc, a, w);
+    }
+    // Spill instead of _mm512_reduce_add_epi32 (GCC 12 warns inside its extract intrinsics)
+    alignas(64) int32_t lanes[16];
+    _mm512_store_si512(lanes, acc);
+    const __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes));
+    const __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes + 8));
+    return horizontalSum(_mm256_add_epi32(low, high));
+#elif defined(__AVXVNNI__)
+    __m256i acc = _mm256_setzero_si256();
+    for (uint32_t i = 0; i < count; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(activations + i));
+        const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        acc = _mm256_dpbusd_avx_epi32(acc, a, w);
+    }
+    return horizontalSum(acc);
+#else
+    int32_t sum = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        sum += static_cast<int32_t>(activations[i]) * static_cast<int32_t>(weights[i]);
+    }
+    return sum;
+#endif
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "cpu_reference.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief INT8 CPU inference for dense networks (same topology and parameters as NeuralBuffers)
+ *
+ * Weights are quantized symmetrically per output row (scale = max|row| / 127) and
+ * activations per layer, with scales found by calibrate() over a sample input set.
+ * Activations are stored as unsigned bytes (q + 128) so the inner product maps onto
+ * dpbusd (u8 x s8 -> s32); the +128 offset is removed with a precomputed row sum:
+ *   sum((q_x + 128) * q_w) - 128 * sum(q_w) = sum(q_x * q_w)
+ *
+ * Kernels, chosen at compile time:
+ * - AVX-512 VNNI (-mavx512vnni): _mm512_dpbusd_epi32, 64 inputs per step
+ * - AVX-VNNI (-mavxvnni):        _mm256_dpbusd_avx_epi32, 32 inputs per step
+ * - Portable:                    plain int32 loop (auto-vectorized where possible)
+ *
+ * Rows are padded to 64 inputs with zero weights (so padding never reaches the sum
+ * or the row sums) and every kernel runs whole vectors. Biases, activation functions and softmax stay in fp32.
+ */
+class QuantizedNetwork {
+public:
+    QuantizedNetwork() = default;
+
+    /**
+     * @brief Initialize for a dense topology (same arguments as NeuralBuffers/CpuReference)
+     */
+    bool initialize(const std::vector<uint32_t>& layerSizes,
+                    const std::vector<uint32_t>& activations);
+
+    /**
+     * @brief Set fp32 parameters (flat, per layer [out][in]); quantized by calibrate()
+     */
+    bool setWeights(const std::vector<float>& weights);
+    bool setBiases(const std::vector<float>& biases);
+
+    /**
+     * @brief Pick activation scales from sample inputs and quantize the weights
+     * @param samples Representative inputs (each topology[0] floats)
+     * @return false if there are no samples or parameters are missing
+     *
+     * Runs the fp32 reference over every sample and records each layer's largest
+     * absolute activation. Inputs outside the calibrated range saturate.
+     */
+    bool calibrate(const std::vector<std::vector<float>>& samples);
+
+    bool isCalibrated() const { return m_calibrated; }
+
+    /**
+     * @brief Run inference with int8 weights and activations
+     */
+    void forward(const std::vector<float>& inputs, std::vector<float>& outputs);
+
+    /**
+     * @brief Name of the compiled dot-product kernel ("avx512-vnni", "avx-vnni" or "portable")
+     */
+    static const char* kernelName();
+
+    static constexpr uint32_t ROW_ALIGN = 64;   // Inputs per padded row
+
+private:
+    struct Layer {
+        uint32_t inputSize = 0;
+        uint32_t outputSize = 0;
+        uint32_t rowStride = 0;             // inputSize rounded up to ROW_ALIGN
+        uint32_t activation = 0;
+        float inputScale = 1.0f;            // Real value of one input quantization step
+        std::vector<int8_t> weights;        // [out][rowStride]
+        std::vector<float> weightScales;    // Per output row
+        std::vector<int32_t> rowSums;       // sum(q_w) per row, for the +128 offset
+    };
+
+    CpuReference m_reference;               // fp32 parameters and calibration runs
+    std::vector<uint32_t> m_topology;
+    std::vector<Layer> m_layers;
+    std::vector<float> m_weights;
+    std::vector<float> m_biases;
+    bool m_calibrated = false;
+
+    std::vector<uint8_t> m_input;           // Quantized activations of the current layer
+    std::vector<uint8_t> m_next;
+    std::vector<float> m_values;            // fp32 outputs of the current layer
+
+    void quantizeActivations(const float* values, uint32_t count, float scale, uint32_t stride,
+                             std::vector<uint8_t>& out) const;
+    static int32_t dot(const uint8_t* activations, const int8_t* weights, uint32_t count);
+};
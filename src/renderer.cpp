@@ -8,6 +8,11 @@ Renderer::~Renderer() {
 }
 
 bool Renderer::initialize(NeuralBuffers& buffers) {
+    if (buffers.getConfig().reuseActivations) {
+        std::cerr << "[ERROR] Renderer needs every layer's activations (disable reuseActivations)\n";
+        return false;
+    }
+
     m_buffers = &buffers;
     m_totalNeurons = buffers.getTotalNeuronCount();
 
@@ -34,6 +39,7 @@ bool Renderer::initialize(NeuralBuffers& buffers) {
     // Create VAO and VBO for neurons
     glGenVertexArrays(1, &m_neuronVAO);
     glGenBuffers(1, &m_neuronPositionVBO);
+    glGenBuffers(1, &m_neuronIndexVBO);
     uploadNeuronPositions();
 
     // Generate and upload connections
@@ -124,10 +130,37 @@ void Renderer::generateNeuronLayout() {
 
     std::cout << "[DEBUG] Generating neuron positions:\n";
 
+    const auto& shapes = m_buffers->getLayerShapes();
+
     for (size_t layerIdx = 0; layerIdx < topology.size(); ++layerIdx) {
         uint32_t layerSize = topology[layerIdx];
         float neuronSpacing = 1.0f;
 
+        // Feature maps: one height x width grid per channel in the y/z plane,
+        // channels stacked along y with a one-neuron gap
+        if (shapes[layerIdx].isSpatial()) {
+            const TensorShape& shape = shapes[layerIdx];
+            float gridSpacing = 0.5f;
+            float channelHeight = static_cast<float>(shape.height + 1) * gridSpacing;
+            float yStart = -(channelHeight * static_cast<float>(shape.channels) - gridSpacing) / 2.0f;
+            float zStart = -(static_cast<float>(shape.width - 1) * gridSpacing) / 2.0f;
+
+            std::cout << "  Layer " << layerIdx << " (" << shape.channels << "x" << shape.height
+                      << "x" << shape.width << " feature map)\n";
+
+            for (uint32_t c = 0; c < shape.channels; ++c) {
+                for (uint32_t row = 0; row < shape.height; ++row) {
+                    for (uint32_t col = 0; col < shape.width; ++col) {
+                        float x = layerIdx * layerSpacing;
+                        float y = yStart + c * channelHeight + row * gridSpacing;
+                        float z = zStart + col * gridSpacing;
+                        m_neuronPositions.emplace_back(x, y, z);
+                    }
+                }
+            }
+            continue;
+        }
+
         // Center the layer vertically (cast to float BEFORE negation to avoid unsigned wraparound)
         float yOffset = -(static_cast<float>(layerSize - 1) * neuronSpacing) / 2.0f;
 
@@ -158,6 +191,26 @@ void Renderer::uploadNeuronPositions() {
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
 
+    // Activation index attribute (location = 1)
+    // Neuron IDs and activation slots differ when layers are padded to vec4
+    std::vector<uint32_t> activationIndices;
+    activationIndices.reserve(m_neuronPositions.size());
+    const auto& topology = m_buffers->getTopology();
+    const auto& activationOffsets = m_buffers->getActivationOffsets();
+    for (size_t layer = 0; layer < topology.size(); ++layer) {
+        for (uint32_t n = 0; n < topology[layer]; ++n) {
+            activationIndices.push_back(activationOffsets[layer] + n);
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_neuronIndexVBO);
+    glBufferData(GL_ARRAY_BUFFER,
+                 activationIndices.size() * sizeof(uint32_t),
+                 activationIndices.data(),
+                 GL_STATIC_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+
     glBindVertexArray(0);
 
     // Verify upload
@@ -168,22 +221,120 @@ void Renderer::uploadNeuronPositions() {
 void Renderer::generateConnections() {
     m_connectionVertices.clear();
 
-    const auto& topology = m_buffers->getTopology();
     const auto& layerInfo = m_buffers->getLayerInfo();
 
-    // Read weights from GPU
+    // Read weights from GPU, with batch norm / input normalization folding undone
     std::vector<float> weights;
-    m_buffers->readWeights(weights);
+    m_buffers->readUnfoldedWeights(weights);
 
     std::cout << "[DEBUG] Generating connections (" << weights.size() << " weights total):\n";
 
     uint32_t neuronOffset = 0;
-    uint32_t weightOffset = 0;
     uint32_t connectionCount = 0;
 
-    for (size_t layerIdx = 0; layerIdx < topology.size() - 1; ++layerIdx) {
-        uint32_t inputSize = topology[layerIdx];
-        uint32_t outputSize = topology[layerIdx + 1];
+    for (size_t layerIdx = 0; layerIdx < layerInfo.size(); ++layerIdx) {
+        uint32_t inputSize = layerInfo[layerIdx].inputSize;
+        uint32_t outputSize = layerInfo[layerIdx].outputSize;
+
+        // readWeights() returns the flat (unsharded) array
+        uint64_t weightOffset = m_buffers->getLayerWeightStart(layerIdx);
+
+        // Conv and pooling layers: one line per window tap that lands inside the input
+        if (!m_buffers->getLayerDescs()[layerIdx].isDense()) {
+            const auto& info = layerInfo[layerIdx];
+            const int k = static_cast<int>(info.kernelSize);
+            const bool pooling = info.layerKind != static_cast<uint32_t>(LayerKind::Conv2D);
+            uint32_t layerConnections = 0;
+
+            for (uint32_t oc = 0; oc < info.outputChannels; ++oc) {
+                for (uint32_t oy = 0; oy < info.outputHeight; ++oy) {
+                    for (uint32_t ox = 0; ox < info.outputWidth; ++ox) {
+                        uint32_t outIdx = (oc * info.outputHeight + oy) * info.outputWidth + ox;
+                        glm::vec3 endPos = m_neuronPositions[neuronOffset + inputSize + outIdx];
+
+                        // Pooling windows stay within their own channel
+                        uint32_t icBegin = pooling ? oc : 0;
+                        uint32_t icEnd = pooling ? oc + 1 : info.inputChannels;
+                        for (uint32_t ic = icBegin; ic < icEnd; ++ic) {
+                            for (int ky = 0; ky < k; ++ky) {
+                                int iy = static_cast<int>(oy * info.stride + ky) - static_cast<int>(info.padding);
+                                if (iy < 0 || iy >= static_cast<int>(info.inputHeight)) continue;
+                                for (int kx = 0; kx < k; ++kx) {
+                                    int ix = static_cast<int>(ox * info.stride + kx) - static_cast<int>(info.padding);
+                                    if (ix < 0 || ix >= static_cast<int>(info.inputWidth)) continue;
+
+                                    uint32_t inIdx = (ic * info.inputHeight + iy) * info.inputWidth + ix;
+
+                                    // Pooling has no weights: max shows as 1, avg as its 1/k^2 share
+                                    float weight = 1.0f;
+                                    if (!pooling) {
+                                        uint64_t weightIdx = weightOffset +
+                                            ((static_cast<uint64_t>(oc) * info.inputChannels + ic) * k + ky) * k + kx;
+                                        weight = weights[weightIdx];
+                                    } else if (info.layerKind == static_cast<uint32_t>(LayerKind::AvgPool2D)) {
+                                        weight = 1.0f / static_cast<float>(k * k);
+                                    }
+
+                                    ConnectionVertex v1;
+                                    v1.position = m_neuronPositions[neuronOffset + inIdx];
+                                    v1.weight = weight;
+                                    m_connectionVertices.push_back(v1);
+
+                                    ConnectionVertex v2;
+                                    v2.position = endPos;
+                                    v2.weight = weight;
+                                    m_connectionVertices.push_back(v2);
+
+                                    layerConnections++;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            std::cout << "  Layer " << layerIdx << ": " << layerConnections
+                      << (pooling ? " connections (pool)\n" : " connections (conv)\n");
+            connectionCount += layerConnections;
+            neuronOffset += inputSize;
+            continue;
+        }
+
+        // Low-rank layers are drawn with their effective weights U * V
+        const float* layerWeights = weights.data() + weightOffset;
+        std::vector<float> effective;
+        if (m_buffers->getLayerDescs()[layerIdx].kind == LayerKind::LowRankDense) {
+            const uint32_t rank = layerInfo[layerIdx].kernelSize;
+            const float* u = layerWeights;
+            const float* v = layerWeights + static_cast<uint64_t>(outputSize) * rank;
+            effective.assign(static_cast<uint64_t>(outputSize) * inputSize, 0.0f);
+            for (uint32_t outIdx = 0; outIdx < outputSize; ++outIdx) {
+                for (uint32_t k = 0; k < rank; ++k) {
+                    const float scale = u[outIdx * rank + k];
+                    for (uint32_t inIdx = 0; inIdx < inputSize; ++inIdx) {
+                        effective[static_cast<uint64_t>(outIdx) * inputSize + inIdx] +=
+                            scale * v[static_cast<uint64_t>(k) * inputSize + inIdx];
+                    }
+                }
+            }
+            layerWeights = effective.data();
+        }
+
+        // Tied layers are drawn with their source's weights (transposed if the tie is)
+        const LayerDesc& desc = m_buffers->getLayerDescs()[layerIdx];
+        if (desc.tiedTo >= 0) {
+            layerWeights = weights.data() + m_buffers->getLayerWeightStart(desc.tiedTo);
+            if (desc.tiedTransposed) {
+                effective.resize(static_cast<uint64_t>(outputSize) * inputSize);
+                for (uint32_t outIdx = 0; outIdx < outputSize; ++outIdx) {
+                    for (uint32_t inIdx = 0; inIdx < inputSize; ++inIdx) {
+                        effective[static_cast<uint64_t>(outIdx) * inputSize + inIdx] =
+                            layerWeights[static_cast<uint64_t>(inIdx) * outputSize + outIdx];
+                    }
+                }
+                layerWeights = effective.data();
+            }
+        }
 
         // Iterate through each output neuron
         for (uint32_t outIdx = 0; outIdx < outputSize; ++outIdx) {
@@ -191,8 +342,7 @@ void Renderer::generateConnections() {
             for (uint32_t inIdx = 0; inIdx < inputSize; ++inIdx) {
                 // Read actual weight value from buffer
                 // Weight layout: weights[layer][out_neuron][in_neuron]
-                uint32_t weightIdx = weightOffset + (outIdx * inputSize) + inIdx;
-                float weight = weights[weightIdx];
+                float weight = layerWeights[static_cast<uint64_t>(outIdx) * inputSize + inIdx];
 
                 glm::vec3 startPos = m_neuronPositions[neuronOffset + inIdx];
                 glm::vec3 endPos = m_neuronPositions[neuronOffset + inputSize + outIdx];
@@ -218,7 +368,36 @@ void Renderer::generateConnections() {
                   << " connections\n";
 
         neuronOffset += inputSize;
-        weightOffset += inputSize * outputSize;
+    }
+
+    // Skip edges: a residual add is an identity connection from the source layer's
+    // neuron i to the output neuron i, drawn with weight 1
+    const auto& topology = m_buffers->getTopology();
+    const auto& descs = m_buffers->getLayerDescs();
+    for (size_t layerIdx = 0; layerIdx < descs.size(); ++layerIdx) {
+        const int32_t source = descs[layerIdx].residualFrom;
+        if (source < 0) continue;
+
+        uint32_t sourceOffset = 0;
+        for (int32_t l = 0; l < source; ++l) sourceOffset += topology[l];
+        uint32_t outputOffset = 0;
+        for (size_t l = 0; l <= layerIdx; ++l) outputOffset += topology[l];
+
+        for (uint32_t i = 0; i < topology[layerIdx + 1]; ++i) {
+            ConnectionVertex v1;
+            v1.position = m_neuronPositions[sourceOffset + i];
+            v1.weight = 1.0f;
+            m_connectionVertices.push_back(v1);
+
+            ConnectionVertex v2;
+            v2.position = m_neuronPositions[outputOffset + i];
+            v2.weight = 1.0f;
+            m_connectionVertices.push_back(v2);
+        }
+
+        std::cout << "  Layer " << layerIdx << ": " << topology[layerIdx + 1]
+                  << " skip connections from layer " << source << "\n";
+        connectionCount += topology[layerIdx + 1];
     }
 
     m_connectionCount = connectionCount;
@@ -286,6 +465,10 @@ void Renderer::cleanup() {
         glDeleteBuffers(1, &m_neuronPositionVBO);
         m_neuronPositionVBO = 0;
     }
+    if (m_neuronIndexVBO) {
+        glDeleteBuffers(1, &m_neuronIndexVBO);
+        m_neuronIndexVBO = 0;
+    }
     if (m_neuronProgram) {
         glDeleteProgram(m_neuronProgram);
         m_neuronProgram = 0;
@@ -60,6 +60,7 @@ public:
 private:
     GLuint m_neuronVAO = 0;
     GLuint m_neuronPositionVBO = 0;     // Per-neuron positions (3D layout)
+    GLuint m_neuronIndexVBO = 0;        // Per-neuron index into the activations SSBO
     GLuint m_neuronProgram = 0;         // Vertex + Fragment shader
 
     GLuint m_connectionVAO = 0;
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Activation list for StaticNetwork (NeuralBuffers::Activation values)
+ */
+template <uint32_t... Activations>
+struct StaticActivations {};
+
+template <typename Activations, uint32_t... Sizes>
+class StaticNetwork;
+
+/**
+ * @brief Dense network with compile-time topology, for tiny models on the CPU
+ *
+ * Layer sizes and activations are template arguments, so every offset is a
+ * constexpr and evaluation is fully unrolled over stack arrays: no heap, no
+ * loops with runtime bounds, no branches on the activation type. Parameters use
+ * the same flat arrays as NeuralBuffers::uploadWeights()/uploadBiases(),
+ * CpuReference and ModelFile (weights per layer [out][in], concatenated).
+ *
+ * Meant for decision models of a few hundred weights, where a dynamic GEMV loop
+ * costs more than the math; larger networks belong in CpuReference or on the GPU.
+ *
+ * Example (XOR):
+ *   StaticNetwork<StaticActivations<0, 3>, 2, 2, 1> net;
+ *   net.setWeights({1, 1, 1, 1, 1, -2});
+ *   net.setBiases({0, -1, 0});
+ *   float y = net.forward({1.0f, 0.0f})[0];
+ */
+template <uint32_t... Activations, uint32_t... Sizes>
+class StaticNetwork<StaticActivations<Activations...>, Sizes...> {
+public:
+    static constexpr size_t kLayerCount = sizeof...(Sizes) - 1;
+    static constexpr std::array<uint32_t, sizeof...(Sizes)> kTopology = {Sizes...};
+    static constexpr std::array<uint32_t, sizeof...(Activations)> kActivations = {Activations...};
+
+    static_assert(sizeof...(Sizes) >= 2, "StaticNetwork needs an input and an output layer");
+    static_assert(sizeof...(Activations) == kLayerCount, "One activation per layer (sizes - 1)");
+
+    // Same offsets as NeuralBuffers::computeOffsets() for a row-major dense network
+    static constexpr uint64_t weightOffset(size_t layer) {
+        uint64_t offset = 0;
+        for (size_t i = 0; i < layer; ++i) offset += static_cast<uint64_t>(kTopology[i]) * kTopology[i + 1];
+        return offset;
+    }
+    static constexpr uint64_t biasOffset(size_t layer) {
+        uint64_t offset = 0;
+        for (size_t i = 0; i < layer; ++i) offset += kTopology[i + 1];
+        return offset;
+    }
+
+    static constexpr uint64_t kWeightCount = weightOffset(kLayerCount);
+    static constexpr uint64_t kBiasCount = biasOffset(kLayerCount);
+    static constexpr uint32_t kInputSize = kTopology.front();
+    static constexpr uint32_t kOutputSize = kTopology.back();
+
+    static_assert(kWeightCount <= 4096, "StaticNetwork unrolls every weight; use CpuReference for larger models");
+
+    using Input = std::array<float, kInputSize>;
+    using Output = std::array<float, kOutputSize>;
+
+    /**
+     * @brief Check that a runtime topology (e.g. from a ModelFile) is this network
+     */
+    static bool matches(const std::vector<uint32_t>& layerSizes, const std::vector<uint32_t>& activations) {
+        return layerSizes == std::vector<uint32_t>(kTopology.begin(), kTopology.end()) &&
+               activations == std::vector<uint32_t>(kActivations.begin(), kActivations.end());
+    }
+
+    bool setWeights(const float* weights, size_t count) {
+        if (count != kWeightCount) {
+            std::cerr << "[ERROR] StaticNetwork: weight count mismatch. Expected "
+                      << kWeightCount << ", got " << count << "\n";
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) m_weights[i] = weights[i];
+        return true;
+    }
+
+    bool setBiases(const float* biases, size_t count) {
+        if (count != kBiasCount) {
+            std::cerr << "[ERROR] StaticNetwork: bias count mismatch. Expected "
+                      << kBiasCount << ", got " << count << "\n";
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) m_biases[i] = biases[i];
+        return true;
+    }
+
+    bool setWeights(const std::vector<float>& weights) { return setWeights(weights.data(), weights.size()); }
+    bool setBiases(const std::vector<float>& biases) { return setBiases(biases.data(), biases.size()); }
+
+    /**
+     * @brief Evaluate the network; everything lives on the stack
+     */
+    Output forward(const Input& input) const {
+        return forwardFrom<0>(input);
+    }
+
+private:
+    std::array<float, kWeightCount> m_weights{};
+    std::array<float, kBiasCount> m_biases{};
+
+    template <size_t Layer>
+    auto forwardFrom(const std::array<float, kTopology[Layer]>& in) const {
+        auto out = layer<Layer>(in, std::make_index_sequence<kTopology[Layer + 1]>{});
+        if constexpr (Layer + 1 == kLayerCount) {
+            return out;
+        } else {
+            return forwardFrom<Layer + 1>(out);
+        }
+    }
+
+    // One dense layer, unrolled over outputs (Os) and inputs (Is)
+    template <size_t Layer, size_t... Os>
+    std::array<float, kTopology[Layer + 1]> layer(const std::array<float, kTopology[Layer]>& in,
+                                                  std::index_sequence<Os...>) const {
+        std::array<float, kTopology[Layer + 1]> out = {
+            activate<kActivations[Layer]>(neuron<Layer, Os>(in, std::make_index_sequence<kTopology[Layer]>{}))...};
+        if constexpr (kActivations[Layer] == kSoftmax) {
+            softmax(out);
+        }
+        return out;
+    }
+
+    template <size_t Layer, size_t O, size_t... Is>
+    float neuron(const std::array<float, kTopology[Layer]>& in, std::index_sequence<Is...>) const {
+        constexpr uint64_t row = weightOffset(Layer) + static_cast<uint64_t>(O) * kTopology[Layer];
+        return (m_biases[biasOffset(Layer) + O] + ... + (in[Is] * m_weights[row + Is]));
+    }
+
+    static constexpr uint32_t kSoftmax = 4;     // NeuralBuffers::Activation::Softmax
+
+    // Same functions as CpuReference::applyActivation
+    template <uint32_t Activation>
+    static float activate(float x) {
+        if constexpr (Activation == 0) {
+            return x > 0.0f ? x : 0.0f;
+        } else if constexpr (Activation == 1) {
+            return 1.0f / (1.0f + std::exp(-x));
+        } else if constexpr (Activation == 2) {
+            return std::tanh(x);
+        } else {
+            return x;   // Linear; softmax is applied over the whole layer
+        }
+    }
+
+    template <size_t N>
+    static void softmax(std::array<float, N>& values) {
+        float maxValue = values[0];
+        for (float v : values) maxValue = v > maxValue ? v : maxValue;
+        float sum = 0.0f;
+        for (float& v : values) {
+            v = std::exp(v - maxValue);
+            sum += v;
+        }
+        for (float& v : values) v /= sum;
+    }
+};
@@ -0,0 +1,198 @@
+#include "gl_context.h"
+#include "nn_buffers.h"
+#include "nn_compute.h"
+#include "cpu_reference.h"
+#include "static_network.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * NeuraVis Buffer Tests
+ *
+ * SSBO layout checks that need a GL context, plus the CPU backends against CpuReference:
+ * - padded_offsets:    with Config::padToVec4, every layer's weightOffset is vec4 aligned,
+ *                      also after conv and low-rank layers whose weight counts are not
+ * - padded_conv_dense: GPU forward of a padded conv -> dense network matches CpuReference
+ * - static_xor:        StaticNetwork matches CpuReference on the XOR weights
+ *
+ * Run from the repository root (shaders are loaded from shaders/). Exits non-zero if any
+ * test fails.
+ *
+ * Usage:
+ *   neuravis_tests
+ */
+
+namespace {
+
+const uint32_t kReLU = static_cast<uint32_t>(NeuralBuffers::Activation::ReLU);
+const uint32_t kLinear = static_cast<uint32_t>(NeuralBuffers::Activation::Linear);
+
+// 6x1x5x5 conv = 150 weights: not a multiple of 4, so the dense layers after it only
+// read the right weights if the conv storage is rounded up to a whole vec4
+TensorShape convInputShape() {
+    TensorShape shape;
+    shape.height = 8;
+    shape.width = 8;
+    return shape;
+}
+
+std::vector<LayerDesc> convDenseLayers() {
+    return {
+        LayerDesc::conv2d(6, 5, 1, 2, kReLU),
+        LayerDesc::dense(10, kReLU),
+        LayerDesc::dense(4, kLinear),
+    };
+}
+
+bool initializePadded(NeuralBuffers& buffers, const TensorShape& inputShape,
+                      const std::vector<LayerDesc>& layers) {
+    NeuralBuffers::Config config;
+    config.padToVec4 = true;
+    buffers.setConfig(config);
+    return buffers.initialize(inputShape, layers);
+}
+
+bool testPaddedOffsets() {
+    // Conv (150 weights) and low-rank rank 3, 150 -> 5 (465 weights), each followed by dense layers
+    TensorShape lowRankInput;
+    lowRankInput.channels = 150;
+    const std::vector<std::pair<TensorShape, std::vector<LayerDesc>>> networks = {
+        {convInputShape(), convDenseLayers()},
+        {lowRankInput, {LayerDesc::lowRankDense(5, 3, kReLU), LayerDesc::dense(2, kReLU),
+                        LayerDesc::dense(3, kLinear)}},
+    };
+
+    for (const auto& [inputShape, layers] : networks) {
+        NeuralBuffers buffers;
+        if (!initializePadded(buffers, inputShape, layers)) {
+            std::cerr << "[FAIL] padded_offsets: initialize failed\n";
+            return false;
+        }
+        const auto& info = buffers.getLayerInfo();
+        for (size_t layer = 0; layer < info.size(); ++layer) {
+            if (info[layer].weightOffset % 4 != 0) {
+                std::cerr << "[FAIL] padded_offsets: layer " << layer << " weightOffset "
+                          << info[layer].weightOffset << " is not vec4 aligned\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool testPaddedConvDense() {
+    const TensorShape inputShape = convInputShape();
+    const std::vector<LayerDesc> layers = convDenseLayers();
+
+    NeuralBuffers buffers;
+    if (!initializePadded(buffers, inputShape, layers)) {
+        std::cerr << "[FAIL] padded_conv_dense: initialize failed\n";
+        return false;
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    std::vector<float> weights(static_cast<size_t>(buffers.getTotalWeightCount()));
+    std::vector<float> biases(static_cast<size_t>(buffers.getTotalBiasCount()));
+    for (float& w : weights) w = dist(rng);
+    for (float& b : biases) b = dist(rng);
+    buffers.uploadWeights(weights);
+    buffers.uploadBiases(biases);
+
+    NeuralCompute compute;
+    CpuReference cpu;
+    if (!compute.initialize("shaders/forward.comp", buffers) ||
+        !cpu.initialize(inputShape, layers) || !cpu.setWeights(weights) || !cpu.setBiases(biases)) {
+        std::cerr << "[FAIL] padded_conv_dense: setup failed\n";
+        return false;
+    }
+
+    float maxDiff = 0.0f;
+    std::vector<float> input(static_cast<size_t>(inputShape.size()));
+    std::vector<float> gpuOutputs, cpuOutputs;
+    std::uniform_real_distribution<float> inputDist(0.0f, 1.0f);
+    for (int sample = 0; sample < 4; ++sample) {
+        for (float& v : input) v = inputDist(rng);
+        buffers.setInputs(input);
+        compute.forward();
+        buffers.readOutputs(gpuOutputs);
+        cpu.forward(input, cpuOutputs);
+        if (gpuOutputs.size() != cpuOutputs.size()) {
+            std::cerr << "[FAIL] padded_conv_dense: output size mismatch\n";
+            return false;
+        }
+        for (size_t i = 0; i < cpuOutputs.size(); ++i) {
+            maxDiff = std::max(maxDiff, std::fabs(gpuOutputs[i] - cpuOutputs[i]));
+        }
+    }
+
+    if (maxDiff > 1e-4f) {
+        std::cerr << "[FAIL] padded_conv_dense: max diff vs CpuReference " << maxDiff << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool testStaticXor() {
+    const std::vector<float> weights = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -2.0f};
+    const std::vector<float> biases = {0.0f, -1.0f, 0.0f};
+
+    StaticNetwork<StaticActivations<0, 3>, 2, 2, 1> net;
+    CpuReference cpu;
+    if (!net.setWeights(weights) || !net.setBiases(biases) || !cpu.initialize({2, 2, 1}, {0, 3}) ||
+        !cpu.setWeights(weights) || !cpu.setBiases(biases)) {
+        std::cerr << "[FAIL] static_xor: setup failed\n";
+        return false;
+    }
+
+    // Integer weights and 0/1 inputs are exact in float, so both must match exactly
+    std::vector<float> cpuOutputs;
+    for (float a : {0.0f, 1.0f}) {
+        for (float b : {0.0f, 1.0f}) {
+            cpu.forward({a, b}, cpuOutputs);
+            const float expected = a != b ? 1.0f : 0.0f;
+            const float actual = net.forward({a, b})[0];
+            if (actual != cpuOutputs[0] || actual != expected) {
+                std::cerr << "[FAIL] static_xor: (" << a << ", " << b << ") gave " << actual
+                          << ", CpuReference " << cpuOutputs[0] << ", expected " << expected << "\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    GLContext context;
+    GLContext::Config config;
+    config.title = "NeuraVis Tests";
+    config.visible = false;
+    config.enableVSync = false;
+
+    if (!context.initialize(config)) {
+        std::cerr << "[ERROR] Failed to initialize OpenGL context\n";
+        return 1;
+    }
+
+    const std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"padded_offsets", testPaddedOffsets},
+        {"padded_conv_dense", testPaddedConvDense},
+        {"static_xor", testStaticXor},
+    };
+
+    int failures = 0;
+    for (const auto& [name, test] : tests) {
+        const bool passed = test();
+        std::cout << (passed ? "[PASS] " : "[FAIL] ") << name << "\n";
+        failures += passed ? 0 : 1;
+    }
+
+    std::cout << "\n" << tests.size() - failures << "/" << tests.size() << " tests passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+#include "gl_context.h"
+#include "nn_buffers.h"
+#include "nn_compute.h"
+#include "neuron_usage.h"
+#include "model_file.h"
+#include "tool_common.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * NeuraVis Model Compactor
+ *
+ * Removes dead and disconnected hidden neurons from a dense model file.
+ *
+ * 1. Runs the sample set on the GPU; NeuronUsage counts how often every neuron activates.
+ * 2. NeuronUsage::compact drops ReLU neurons that never fired and neurons whose outgoing
+ *    weights are all zero, and remaps the weights and biases.
+ * 3. Rebuilds the network with the smaller topology, runs the samples again and requires
+ *    every output to be bit-identical to the original before writing the model.
+ *
+ * A neuron that never fired on the samples may still fire on other inputs: use a sample
+ * set that covers the inputs the model will serve.
+ *
+ * Usage:
+ *   neuravis_compact --model IN.nvm --out OUT.nvm [--samples FILE] [--count N]
+ *
+ * --samples is raw little-endian float32, inputSize values per sample; without it,
+ * --count (default 1024) uniform [0, 1) inputs are generated.
+ */
+
+namespace {
+
+struct CompactOptions {
+    std::string modelPath;
+    std::string outPath;
+    std::string samplesPath;
+    uint32_t sampleCount = 1024;
+};
+
+bool parseArgs(int argc, char** argv, CompactOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](std::string& value) {
+            if (i + 1 >= argc) return false;
+            value = argv[++i];
+            return true;
+        };
+
+        std::string value;
+        if (arg == "--model" && next(value)) {
+            options.modelPath = value;
+        } else if (arg == "--out" && next(value)) {
+            options.outPath = value;
+        } else if (arg == "--samples" && next(value)) {
+            options.samplesPath = value;
+        } else if (arg == "--count" && next(value)) {
+            uint64_t count = 0;
+            if (!tools::parseUnsigned(value, 1, UINT32_MAX, count)) {
+                std::cerr << "[ERROR] --count must be between 1 and " << UINT32_MAX << "\n";
+                return false;
+            }
+            options.sampleCount = static_cast<uint32_t>(count);
+        } else {
+            std::cerr << "[ERROR] Unknown or incomplete argument: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (options.modelPath.empty() || options.outPath.empty()) {
+        std::cerr << "[ERROR] --model and --out are required\n";
+        return false;
+    }
+    return true;
+}
+
+// Count the outputs whose bit pattern differs (NaN payloads included)
+size_t countMismatches(const std::vector<float>& a, const std::vector<float>& b) {
+    if (a.size() != b.size()) return std::max(a.size(), b.size());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        mismatches += std::memcmp(&a[i], &b[i], sizeof(float)) != 0 ? 1 : 0;
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CompactOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        return 1;
+    }
+
+    // Hidden window: we only need a context
+    GLContext context;
+    GLContext::Config config;
+    config.title = "NeuraVis Model Compactor";
+    config.visible = false;
+    config.enableVSync = false;
+    config.enableDebugOutput = false;
+    if (!context.initialize(config)) {
+        std::cerr << "[ERROR] Failed to initialize OpenGL context\n";
+        return 1;
+    }
+
+    ModelFile model;
+    if (!model.open(options.modelPath)) {
+        return 1;
+    }
+    const auto& ranks = model.getRanks();
+    const auto& ties = model.getTies();
+    if (std::any_of(ranks.begin(), ranks.end(), [](uint32_t rank) { return rank > 0; }) ||
+        std::any_of(ties.begin(), ties.end(), [](uint32_t tie) { return tie != 0; })) {
+        std::cerr << "[ERROR] Compaction needs a plain dense model (this one has low-rank or tied layers)\n";
+        return 1;
+    }
+    const std::vector<uint32_t>& topology = model.getTopology();
+    const std::vector<uint32_t>& activations = model.getActivations();
+
+    std::vector<std::vector<float>> samples;
+    if (!tools::loadSamples(options.samplesPath, options.sampleCount, topology[0], samples)) {
+        return 1;
+    }
+
+    // 1. Count activations and keep the reference outputs
+    NeuralBuffers buffers;
+    if (!buffers.initialize(topology, activations) || !model.uploadTo(buffers)) {
+        return 1;
+    }
+    NeuralCompute compute;
+    NeuronUsage usage;
+    if (!compute.initialize("shaders/forward.comp", buffers) ||
+        !usage.initialize("shaders/activation_count.comp", buffers)) {
+        return 1;
+    }
+
+    std::vector<std::vector<float>> reference(samples.size());
+    for (size_t s = 0; s < samples.size(); ++s) {
+        usage.accumulate(compute, samples[s]);
+        buffers.readOutputs(reference[s]);
+    }
+    std::vector<uint32_t> counts;
+    usage.readCounts(counts);
+
+    // 2. Compact
+    const std::vector<float> weights(model.getWeights(), model.getWeights() + buffers.getTotalWeightCount());
+    const std::vector<float> biases(model.getBiases(), model.getBiases() + buffers.getTotalBiasCount());
+    NeuronUsage::CompactNetwork compacted;
+    if (!NeuronUsage::compact(topology, activations, weights, biases, counts, compacted)) {
+        return 1;
+    }
+
+    std::cout << "\nlayer  neurons  never fired  kept\n";
+    uint32_t countStart = 0;
+    for (size_t layer = 0; layer < topology.size(); ++layer) {
+        uint32_t silent = 0;
+        for (uint32_t n = 0; n < topology[layer]; ++n) {
+            silent += counts[countStart + n] == 0 ? 1 : 0;
+        }
+        countStart += topology[layer];
+
+        char line[96];
+        std::snprintf(line, sizeof(line), "%5zu  %7u  %11u  %4u\n",
+                      layer, topology[layer], silent, compacted.topology[layer]);
+        std::cout << line;
+    }
+    std::cout << "\nweights " << weights.size() << " -> " << compacted.weights.size()
+              << ", biases " << biases.size() << " -> " << compacted.biases.size()
+              << " (" << usage.getSampleCount() << " samples)\n";
+
+    // 3. The compacted network must reproduce every reference output bit for bit
+    NeuralBuffers compactBuffers;
+    NeuralCompute compactCompute;
+    if (!NeuronUsage::rebuild(compactBuffers, compacted) ||
+        !compactCompute.initialize("shaders/forward.comp", compactBuffers)) {
+        return 1;
+    }
+
+    size_t mismatches = 0;
+    std::vector<float> outputs;
+    for (size_t s = 0; s < samples.size(); ++s) {
+        compactCompute.infer(samples[s], outputs);
+        mismatches += countMismatches(outputs, reference[s]);
+    }
+    if (mismatches > 0) {
+        std::cerr << "[ERROR] " << mismatches << " outputs differ after compaction, model not written\n";
+        return 1;
+    }
+    std::cout << "[INFO] All " << samples.size() * topology.back() << " outputs bit-identical\n";
+
+    if (!ModelFile::write(options.outPath, compacted.topology, compacted.activations,
+                          compacted.weights, compacted.biases)) {
+        return 1;
+    }
+    return 0;
+}
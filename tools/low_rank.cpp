@@ -0,0 +1,470 @@
+#include "model_file.h"
+#include "layer_desc.h"
+#include "nn_buffers.h"
+#include "tool_common.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * NeuraVis Low-Rank Factorizer
+ *
+ * Replaces dense layers of a model file with LayerKind::LowRankDense factors from a
+ * truncated SVD: W (out x in) ~= U (out x r) * V (r x in), which is the best rank-r
+ * approximation in the Frobenius norm.
+ *
+ * The SVD comes from the eigendecomposition of the smaller Gram matrix (W W^T or W^T W,
+ * in double precision; Householder tridiagonalization + implicit QL). With out <= in:
+ * U = the top r eigenvectors of W W^T, V = U^T W (and symmetrically otherwise).
+ *
+ * The rank is fixed (--rank) or the smallest one whose relative Frobenius error
+ * ||W - U V|| / ||W|| is within --max-error. A layer keeps its dense weights when the
+ * factors would not be smaller than the full matrix. Ranks are capped at
+ * NeuralBuffers::MAX_LOW_RANK, so a wide layer may end up above --max-error.
+ *
+ * Usage:
+ *   neuravis_lowrank --model IN.nvm --out OUT.nvm [--layers 0,2] (--rank R | --max-error E)
+ *
+ * --layers defaults to every dense layer; --max-error defaults to 0.01.
+ */
+
+namespace {
+
+struct FactorOptions {
+    std::string modelPath;
+    std::string outPath;
+    std::vector<size_t> layers;     // Empty = all dense layers
+    uint32_t rank = 0;              // 0 = choose by maxError
+    double maxError = 0.01;
+};
+
+bool parseLayers(const std::string& value, std::vector<size_t>& layers) {
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        uint64_t layer = 0;
+        if (!tools::parseUnsigned(item, 0, UINT32_MAX, layer)) {
+            return false;
+        }
+        layers.push_back(static_cast<size_t>(layer));
+    }
+    return !layers.empty();
+}
+
+bool parseArgs(int argc, char** argv, FactorOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](std::string& value) {
+            if (i + 1 >= argc) return false;
+            value = argv[++i];
+            return true;
+        };
+
+        std::string value;
+        if (arg == "--model" && next(value)) {
+            options.modelPath = value;
+        } else if (arg == "--out" && next(value)) {
+            options.outPath = value;
+        } else if (arg == "--layers" && next(value)) {
+            if (!parseLayers(value, options.layers)) {
+                std::cerr << "[ERROR] --layers expects a comma-separated list of layer indices\n";
+                return false;
+            }
+        } else if (arg == "--rank" && next(value)) {
+            uint64_t rank = 0;
+            if (!tools::parseUnsigned(value, 1, NeuralBuffers::MAX_LOW_RANK, rank)) {
+                std::cerr << "[ERROR] --rank must be between 1 and " << NeuralBuffers::MAX_LOW_RANK << "\n";
+                return false;
+            }
+            options.rank = static_cast<uint32_t>(rank);
+        } else if (arg == "--max-error" && next(value)) {
+            if (!tools::parseNonNegative(value, options.maxError)) {
+                std::cerr << "[ERROR] --max-error must be a non-negative number\n";
+                return false;
+            }
+        } else {
+            std::cerr << "[ERROR] Unknown or incomplete argument: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (options.modelPath.empty() || options.outPath.empty()) {
+        std::cerr << "[ERROR] --model and --out are required\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Eigendecomposition of a symmetric n x n matrix (row-major, overwritten with the
+ * eigenvectors as columns), eigenvalues in descending order.
+ * Householder reduction to tridiagonal form followed by the implicit QL algorithm.
+ */
+void symmetricEigen(std::vector<double>& a, int n, std::vector<double>& values) {
+    auto V = [&](int row, int col) -> double& { return a[static_cast<size_t>(row) * n + col]; };
+    std::vector<double> d(n), e(n, 0.0);
+
+    // Householder tridiagonalization, accumulating the transformations in V
+    for (int j = 0; j < n; ++j) {
+        d[j] = V(n - 1, j);
+    }
+    for (int i = n - 1; i > 0; --i) {
+        double scale = 0.0;
+        double h = 0.0;
+        for (int k = 0; k < i; ++k) {
+            scale += std::fabs(d[k]);
+        }
+        if (scale == 0.0) {
+            e[i] = d[i - 1];
+            for (int j = 0; j < i; ++j) {
+                d[j] = V(i - 1, j);
+                V(i, j) = 0.0;
+                V(j, i) = 0.0;
+            }
+        } else {
+            for (int k = 0; k < i; ++k) {
+                d[k] /= scale;
+                h += d[k] * d[k];
+            }
+            double f = d[i - 1];
+            double g = f > 0.0 ? -std::sqrt(h) : std::sqrt(h);
+            e[i] = scale * g;
+            h -= f * g;
+            d[i - 1] = f - g;
+            for (int j = 0; j < i; ++j) {
+                e[j] = 0.0;
+            }
+
+            for (int j = 0; j < i; ++j) {
+                f = d[j];
+                V(j, i) = f;
+                g = e[j] + V(j, j) * f;
+                for (int k = j + 1; k <= i - 1; ++k) {
+                    g += V(k, j) * d[k];
+                    e[k] += V(k, j) * f;
+                }
+                e[j] = g;
+            }
+            f = 0.0;
+            for (int j = 0; j < i; ++j) {
+                e[j] /= h;
+                f += e[j] * d[j];
+            }
+            const double hh = f / (h + h);
+            for (int j = 0; j < i; ++j) {
+                e[j] -= hh * d[j];
+            }
+            for (int j = 0; j < i; ++j) {
+                f = d[j];
+                g = e[j];
+                for (int k = j; k <= i - 1; ++k) {
+                    V(k, j) -= f * e[k] + g * d[k];
+                }
+                d[j] = V(i - 1, j);
+                V(i, j) = 0.0;
+            }
+        }
+        d[i] = h;
+    }
+
+    for (int i = 0; i < n - 1; ++i) {
+        V(n - 1, i) = V(i, i);
+        V(i, i) = 1.0;
+        const double h = d[i + 1];
+        if (h != 0.0) {
+            for (int k = 0; k <= i; ++k) {
+                d[k] = V(k, i + 1) / h;
+            }
+            for (int j = 0; j <= i; ++j) {
+                double g = 0.0;
+                for (int k = 0; k <= i; ++k) {
+                    g += V(k, i + 1) * V(k, j);
+                }
+                for (int k = 0; k <= i; ++k) {
+                    V(k, j) -= g * d[k];
+                }
+            }
+        }
+        for (int k = 0; k <= i; ++k) {
+            V(k, i + 1) = 0.0;
+        }
+    }
+    for (int j = 0; j < n; ++j) {
+        d[j] = V(n - 1, j);
+        V(n - 1, j) = 0.0;
+    }
+    V(n - 1, n - 1) = 1.0;
+    e[0] = 0.0;
+
+    // Implicit QL on the tridiagonal matrix
+    for (int i = 1; i < n; ++i) {
+        e[i - 1] = e[i];
+    }
+    e[n - 1] = 0.0;
+
+    double f = 0.0;
+    double tst1 = 0.0;
+    const double eps = std::ldexp(1.0, -52);
+    for (int l = 0; l < n; ++l) {
+        tst1 = std::max(tst1, std::fabs(d[l]) + std::fabs(e[l]));
+        int m = l;
+        while (m < n - 1 && std::fabs(e[m]) > eps * tst1) {
+            ++m;
+        }
+
+        if (m > l) {
+            do {
+                double g = d[l];
+                double p = (d[l + 1] - g) / (2.0 * e[l]);
+                double r = std::hypot(p, 1.0);
+                if (p < 0.0) r = -r;
+                d[l] = e[l] / (p + r);
+                d[l + 1] = e[l] * (p + r);
+                const double dl1 = d[l + 1];
+                double h = g - d[l];
+                for (int i = l + 2; i < n; ++i) {
+                    d[i] -= h;
+                }
+                f += h;
+
+                p = d[m];
+                double c = 1.0, c2 = 1.0, c3 = 1.0;
+                const double el1 = e[l + 1];
+                double s = 0.0, s2 = 0.0;
+                for (int i = m - 1; i >= l; --i) {
+                    c3 = c2;
+                    c2 = c;
+                    s2 = s;
+                    g = c * e[i];
+                    h = c * p;
+                    r = std::hypot(p, e[i]);
+                    e[i + 1] = s * r;
+                    s = e[i] / r;
+                    c = p / r;
+                    p = c * d[i] - s * g;
+                    d[i + 1] = h + s * (c * g + s * d[i]);
+                    for (int k = 0; k < n; ++k) {
+                        h = V(k, i + 1);
+                        V(k, i + 1) = s * V(k, i) + c * h;
+                        V(k, i) = c * V(k, i) - s * h;
+                    }
+                }
+                p = -s * s2 * c3 * el1 * e[l] / dl1;
+                e[l] = s * p;
+                d[l] = c * p;
+            } while (std::fabs(e[l]) > eps * tst1);
+        }
+        d[l] += f;
+        e[l] = 0.0;
+    }
+
+    // Descending eigenvalues, eigenvector columns permuted to match
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int x, int y) { return d[x] > d[y]; });
+    std::vector<double> sorted(a.size());
+    values.resize(n);
+    for (int j = 0; j < n; ++j) {
+        values[j] = d[order[j]];
+        for (int k = 0; k < n; ++k) {
+            sorted[static_cast<size_t>(k) * n + j] = V(k, order[j]);
+        }
+    }
+    a.swap(sorted);
+}
+
+struct Factorization {
+    uint32_t rank = 0;
+    double relativeError = 0.0;
+    bool clamped = false;           // Rank capped at NeuralBuffers::MAX_LOW_RANK
+    std::vector<float> factors;     // U [out][r] then V [r][in]
+};
+
+// Truncated SVD of one out x in layer
+Factorization factorize(const float* weights, uint32_t out, uint32_t in, const FactorOptions& options) {
+    // Gram matrix of the smaller side: G = W W^T (out <= in) or W^T W
+    const bool rowSide = out <= in;
+    const int n = static_cast<int>(rowSide ? out : in);
+    std::vector<double> gram(static_cast<size_t>(n) * n, 0.0);
+    for (int a = 0; a < n; ++a) {
+        for (int b = 0; b <= a; ++b) {
+            double sum = 0.0;
+            if (rowSide) {
+                const float* ra = weights + static_cast<size_t>(a) * in;
+                const float* rb = weights + static_cast<size_t>(b) * in;
+                for (uint32_t i = 0; i < in; ++i) sum += static_cast<double>(ra[i]) * rb[i];
+            } else {
+                for (uint32_t o = 0; o < out; ++o) {
+                    sum += static_cast<double>(weights[static_cast<size_t>(o) * in + a]) *
+                           weights[static_cast<size_t>(o) * in + b];
+                }
+            }
+            gram[static_cast<size_t>(a) * n + b] = sum;
+            gram[static_cast<size_t>(b) * n + a] = sum;
+        }
+    }
+
+    // Eigenvalues are the squared singular values
+    std::vector<double> sigma2;
+    symmetricEigen(gram, n, sigma2);
+    double total = 0.0;
+    for (double& value : sigma2) {
+        value = std::max(value, 0.0);
+        total += value;
+    }
+
+    Factorization result;
+    if (options.rank > 0) {
+        result.rank = std::min<uint32_t>(options.rank, static_cast<uint32_t>(n));
+    } else {
+        // Smallest rank whose discarded energy is within the bound
+        double tail = total;
+        result.rank = static_cast<uint32_t>(n);
+        for (uint32_t r = 0; r < static_cast<uint32_t>(n); ++r) {
+            if (total == 0.0 || std::sqrt(tail / total) <= options.maxError) {
+                result.rank = std::max(r, 1u);
+                break;
+            }
+            tail -= sigma2[r];
+        }
+    }
+
+    // NeuralBuffers (and low_rank_dense.comp) reject anything wider
+    if (result.rank > NeuralBuffers::MAX_LOW_RANK) {
+        result.rank = NeuralBuffers::MAX_LOW_RANK;
+        result.clamped = true;
+    }
+    double tail = 0.0;
+    for (uint32_t r = result.rank; r < static_cast<uint32_t>(n); ++r) {
+        tail += sigma2[r];
+    }
+    result.relativeError = total > 0.0 ? std::sqrt(tail / total) : 0.0;
+
+    const uint32_t rank = result.rank;
+    result.factors.assign(static_cast<size_t>(rank) * (out + in), 0.0f);
+    float* u = result.factors.data();
+    float* v = u + static_cast<size_t>(out) * rank;
+    auto eigenvector = [&](uint32_t component, int index) { return gram[static_cast<size_t>(index) * n + component]; };
+
+    if (rowSide) {
+        // U = top eigenvectors of W W^T, V = U^T W
+        for (uint32_t k = 0; k < rank; ++k) {
+            for (uint32_t o = 0; o < out; ++o) {
+                u[static_cast<size_t>(o) * rank + k] = static_cast<float>(eigenvector(k, static_cast<int>(o)));
+            }
+            for (uint32_t i = 0; i < in; ++i) {
+                double sum = 0.0;
+                for (uint32_t o = 0; o < out; ++o) {
+                    sum += eigenvector(k, static_cast<int>(o)) * weights[static_cast<size_t>(o) * in + i];
+                }
+                v[static_cast<size_t>(k) * in + i] = static_cast<float>(sum);
+            }
+        }
+    } else {
+        // V = top eigenvectors of W^T W (as rows), U = W V^T
+        for (uint32_t k = 0; k < rank; ++k) {
+            for (uint32_t i = 0; i < in; ++i) {
+                v[static_cast<size_t>(k) * in + i] = static_cast<float>(eigenvector(k, static_cast<int>(i)));
+            }
+            for (uint32_t o = 0; o < out; ++o) {
+                double sum = 0.0;
+                for (uint32_t i = 0; i < in; ++i) {
+                    sum += weights[static_cast<size_t>(o) * in + i] * eigenvector(k, static_cast<int>(i));
+                }
+                u[static_cast<size_t>(o) * rank + k] = static_cast<float>(sum);
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FactorOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        return 1;
+    }
+
+    ModelFile model;
+    if (!model.open(options.modelPath)) {
+        return 1;
+    }
+
+    const std::vector<uint32_t>& topology = model.getTopology();
+    const std::vector<LayerDesc> layers = model.getLayers();
+    std::vector<bool> selected(layers.size(), options.layers.empty());
+    for (size_t layer : options.layers) {
+        if (layer >= layers.size()) {
+            std::cerr << "[ERROR] Layer " << layer << " out of range (model has " << layers.size() << ")\n";
+            return 1;
+        }
+        selected[layer] = true;
+    }
+
+    // Shared matrices stay dense: low-rank layers cannot be tied
+    std::vector<bool> tied(layers.size(), false);
+    for (size_t layer = 0; layer < layers.size(); ++layer) {
+        if (layers[layer].tiedTo < 0) continue;
+        tied[layer] = true;
+        tied[layers[layer].tiedTo] = true;
+    }
+
+    std::vector<float> weights;
+    std::vector<uint32_t> ranks = model.getRanks();
+    const float* source = model.getWeights();
+    TensorShape shape = model.getInputShape();
+    uint64_t weightsBefore = 0;
+
+    std::cout << "\nlayer  shape          rank   rel. error   weights\n";
+    for (size_t layer = 0; layer < layers.size(); ++layer) {
+        const LayerDesc& desc = layers[layer];
+        const uint64_t count = layerWeightCount(shape, desc);
+        const uint32_t in = topology[layer];
+        const uint32_t out = topology[layer + 1];
+        weightsBefore += count;
+
+        Factorization result;
+        bool keep = !selected[layer] || desc.kind != LayerKind::Dense || tied[layer];
+        if (!keep) {
+            result = factorize(source, out, in, options);
+            keep = result.factors.size() >= count;
+        }
+
+        char line[160];
+        if (keep) {
+            weights.insert(weights.end(), source, source + count);
+            std::snprintf(line, sizeof(line), "%5zu  %5u x %-5u  %-5s  %-11s  %llu%s\n", layer, out, in,
+                          ranks[layer] > 0 ? std::to_string(ranks[layer]).c_str() : tied[layer] ? "tied" : "full",
+                          "-", static_cast<unsigned long long>(count),
+                          selected[layer] && desc.kind == LayerKind::Dense && !tied[layer]
+                              ? " (factors not smaller, kept)" : "");
+        } else {
+            weights.insert(weights.end(), result.factors.begin(), result.factors.end());
+            ranks[layer] = result.rank;
+            std::snprintf(line, sizeof(line), "%5zu  %5u x %-5u  %-5u  %.3e    %llu -> %zu%s\n", layer, out,
+                          in, result.rank, result.relativeError, static_cast<unsigned long long>(count),
+                          result.factors.size(), result.clamped ? " (rank capped)" : "");
+        }
+        std::cout << line;
+
+        source += count;
+        shape = layerOutputShape(shape, desc);
+    }
+
+    // Weights and MACs per inference shrink by the same factor
+    std::vector<float> biases(model.getBiases(), model.getBiases() + model.getBiasCount());
+    std::cout << "\nweights " << weightsBefore << " -> " << weights.size() << " ("
+              << static_cast<double>(weightsBefore) / static_cast<double>(std::max<size_t>(weights.size(), 1))
+              << "x smaller)\n";
+
+    if (!ModelFile::write(options.outPath, topology, model.getActivations(), weights, biases, ranks,
+                          model.getTies())) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,319 @@
+#include "gl_context.h"
+#include "nn_buffers.h"
+#include "nn_compute.h"
+#include "model_file.h"
+#include "tool_common.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * NeuraVis Precision Tuner
+ *
+ * Picks a per-layer weight precision (fp32/fp16/int8) for a model under an accuracy budget
+ * and writes a policy file for NeuralBuffers::Config::precisionPolicyPath.
+ *
+ * 1. Runs the sample set on the GPU with every layer in fp32 (reference outputs) and
+ *    times each layer with GL_TIME_ELAPSED queries.
+ * 2. For every dense layer and reduced precision, runs again with only that layer changed:
+ *    divergence = max |output - reference| over all samples, plus that layer's time.
+ * 3. Gives each layer the fastest precision whose own divergence is within budget, then
+ *    checks the combination; while it is over budget, the layer with the largest
+ *    divergence is stepped back (int8 -> fp16 -> fp32).
+ *
+ * Usage:
+ *   neuravis_precision --model FILE.nvm [--samples FILE] [--count N]
+ *                      [--budget 1e-3] [--iterations N] [--out policy.txt]
+ *
+ * --samples is raw little-endian float32, inputSize values per sample; without it,
+ * --count (default 256) uniform [0, 1) inputs are generated.
+ */
+
+namespace {
+
+using Precision = NeuralBuffers::Precision;
+
+struct TuneOptions {
+    std::string modelPath;
+    std::string samplesPath;
+    std::string outPath = "precision_policy.txt";
+    uint32_t sampleCount = 256;
+    double budget = 1e-3;
+    int iterations = 50;
+};
+
+struct Evaluation {
+    double maxDivergence = 0.0;
+    double meanDivergence = 0.0;
+    std::vector<double> layerMs;        // Mean GPU time per layer
+    std::vector<std::vector<float>> outputs;
+};
+
+bool parseArgs(int argc, char** argv, TuneOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](std::string& value) {
+            if (i + 1 >= argc) return false;
+            value = argv[++i];
+            return true;
+        };
+
+        std::string value;
+        if (arg == "--model" && next(value)) {
+            options.modelPath = value;
+        } else if (arg == "--samples" && next(value)) {
+            options.samplesPath = value;
+        } else if (arg == "--count" && next(value)) {
+            uint64_t count = 0;
+            if (!tools::parseUnsigned(value, 1, UINT32_MAX, count)) {
+                std::cerr << "[ERROR] --count must be between 1 and " << UINT32_MAX << "\n";
+                return false;
+            }
+            options.sampleCount = static_cast<uint32_t>(count);
+        } else if (arg == "--budget" && next(value)) {
+            if (!tools::parseNonNegative(value, options.budget)) {
+                std::cerr << "[ERROR] --budget must be a non-negative number\n";
+                return false;
+            }
+        } else if (arg == "--iterations" && next(value)) {
+            uint64_t iterations = 0;
+            if (!tools::parseUnsigned(value, 1, INT_MAX, iterations)) {
+                std::cerr << "[ERROR] --iterations must be between 1 and " << INT_MAX << "\n";
+                return false;
+            }
+            options.iterations = static_cast<int>(iterations);
+        } else if (arg == "--out" && next(value)) {
+            options.outPath = value;
+        } else {
+            std::cerr << "[ERROR] Unknown or incomplete argument: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (options.modelPath.empty()) {
+        std::cerr << "[ERROR] --model is required\n";
+        return false;
+    }
+    return true;
+}
+
+// Run every sample with the given per-layer precisions, compare against reference
+// (if given) and time each layer
+bool evaluate(const ModelFile& model, const std::vector<Precision>& precisions,
+              const std::vector<std::vector<float>>& samples, const std::vector<std::vector<float>>* reference,
+              int iterations, Evaluation& result) {
+    NeuralBuffers buffers;
+    NeuralBuffers::Config config;
+    config.layerPrecision = precisions;
+    buffers.setConfig(config);
+    if (!buffers.initialize(model.getInputShape(), model.getLayers()) || !model.uploadTo(buffers)) {
+        return false;
+    }
+
+    NeuralCompute compute;
+    if (!compute.initialize("shaders/forward.comp", buffers)) {
+        return false;
+    }
+
+    result.outputs.resize(samples.size());
+    for (size_t s = 0; s < samples.size(); ++s) {
+        compute.infer(samples[s], result.outputs[s]);
+    }
+
+    result.maxDivergence = 0.0;
+    result.meanDivergence = 0.0;
+    if (reference) {
+        size_t count = 0;
+        for (size_t s = 0; s < samples.size(); ++s) {
+            for (size_t o = 0; o < result.outputs[s].size(); ++o) {
+                const double diff = std::fabs(static_cast<double>(result.outputs[s][o]) - (*reference)[s][o]);
+                result.maxDivergence = std::max(result.maxDivergence, diff);
+                result.meanDivergence += diff;
+                ++count;
+            }
+        }
+        result.meanDivergence /= static_cast<double>(std::max<size_t>(count, 1));
+    }
+
+    // Per-layer GPU time (each query blocks, so layers are measured in isolation)
+    const size_t layerCount = compute.getLayerCount();
+    result.layerMs.assign(layerCount, 0.0);
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    buffers.setInputs(samples[0]);
+    for (int it = 0; it < iterations; ++it) {
+        for (size_t layer = 0; layer < layerCount; ++layer) {
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            compute.forwardLayer(layer);
+            glEndQuery(GL_TIME_ELAPSED);
+
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNs);
+            result.layerMs[layer] += static_cast<double>(elapsedNs) / 1.0e6;
+        }
+    }
+    glDeleteQueries(1, &query);
+    for (double& ms : result.layerMs) {
+        ms /= iterations;
+    }
+    return true;
+}
+
+std::string formatMs(double ms) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.4f ms", ms);
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    TuneOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        return 1;
+    }
+
+    // Hidden window: we only need a context, and VSync must not throttle us
+    GLContext context;
+    GLContext::Config config;
+    config.title = "NeuraVis Precision Tuner";
+    config.visible = false;
+    config.enableVSync = false;
+    config.enableDebugOutput = false;
+    if (!context.initialize(config)) {
+        std::cerr << "[ERROR] Failed to initialize OpenGL context\n";
+        return 1;
+    }
+
+    ModelFile model;
+    if (!model.open(options.modelPath)) {
+        return 1;
+    }
+    const size_t layerCount = model.getActivations().size();
+
+    std::vector<std::vector<float>> samples;
+    if (!tools::loadSamples(options.samplesPath, options.sampleCount, model.getTopology()[0], samples)) {
+        return 1;
+    }
+
+    // 1. fp32 reference
+    Evaluation baseline;
+    std::vector<Precision> policy(layerCount, Precision::FP32);
+    if (!evaluate(model, policy, samples, nullptr, options.iterations, baseline)) {
+        std::cerr << "[ERROR] fp32 reference run failed\n";
+        return 1;
+    }
+
+    // 2. One layer at a time: [layer][precision] divergence and layer time
+    // Only plain dense layers have reduced precisions (low-rank and tied layers stay fp32)
+    const Precision candidates[] = {Precision::FP16, Precision::INT8};
+    const std::vector<LayerDesc> layers = model.getLayers();
+    std::vector<bool> tunable(layerCount);
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        tunable[layer] = layers[layer].kind == LayerKind::Dense && layers[layer].tiedTo < 0;
+    }
+    for (const LayerDesc& desc : layers) {
+        if (desc.tiedTo >= 0) tunable[desc.tiedTo] = false;
+    }
+    std::vector<std::vector<Evaluation>> single(layerCount, std::vector<Evaluation>(3));
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        single[layer][0].layerMs = baseline.layerMs;
+        if (!tunable[layer]) continue;
+        for (Precision precision : candidates) {
+            std::vector<Precision> trial(layerCount, Precision::FP32);
+            trial[layer] = precision;
+            if (!evaluate(model, trial, samples, &baseline.outputs, options.iterations,
+                          single[layer][static_cast<size_t>(precision)])) {
+                std::cerr << "[ERROR] Layer " << layer << " " << NeuralBuffers::precisionName(precision)
+                          << " run failed\n";
+                return 1;
+            }
+            single[layer][static_cast<size_t>(precision)].outputs.clear();
+        }
+    }
+
+    // 3. Fastest precision per layer that meets the budget on its own
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        if (!tunable[layer]) continue;
+        double best = baseline.layerMs[layer];
+        for (Precision precision : candidates) {
+            const Evaluation& e = single[layer][static_cast<size_t>(precision)];
+            if (e.maxDivergence <= options.budget && e.layerMs[layer] < best) {
+                best = e.layerMs[layer];
+                policy[layer] = precision;
+            }
+        }
+    }
+
+    // Errors compound across layers: step back the worst offender until the mix fits
+    Evaluation combined;
+    while (true) {
+        if (!evaluate(model, policy, samples, &baseline.outputs, options.iterations, combined)) {
+            std::cerr << "[ERROR] Combined policy run failed\n";
+            return 1;
+        }
+        if (combined.maxDivergence <= options.budget) {
+            break;
+        }
+
+        size_t worst = layerCount;
+        for (size_t layer = 0; layer < layerCount; ++layer) {
+            if (policy[layer] == Precision::FP32) continue;
+            if (worst == layerCount ||
+                single[layer][static_cast<size_t>(policy[layer])].maxDivergence >
+                single[worst][static_cast<size_t>(policy[worst])].maxDivergence) {
+                worst = layer;
+            }
+        }
+        if (worst == layerCount) {
+            break;      // All fp32: divergence is run-to-run noise only
+        }
+        policy[worst] = policy[worst] == Precision::INT8 &&
+                        single[worst][static_cast<size_t>(Precision::FP16)].maxDivergence <= options.budget
+                            ? Precision::FP16 : Precision::FP32;
+        std::cout << "[INFO] Combined divergence " << combined.maxDivergence << " over budget, layer "
+                  << worst << " -> " << NeuralBuffers::precisionName(policy[worst]) << "\n";
+    }
+
+    // Report and write the policy
+    std::vector<std::string> comments;
+    double fp32Total = 0.0, policyTotal = 0.0;
+    std::cout << "\nlayer  fp32 ms     fp16 ms (max div)        int8 ms (max div)        chosen\n";
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        const Evaluation& half = single[layer][static_cast<size_t>(Precision::FP16)];
+        const Evaluation& int8 = single[layer][static_cast<size_t>(Precision::INT8)];
+        char line[160];
+        if (!tunable[layer]) {
+            std::snprintf(line, sizeof(line), "%5zu  %.4f     -                        -                        %s\n",
+                          layer, baseline.layerMs[layer], NeuralBuffers::precisionName(policy[layer]));
+        } else {
+            std::snprintf(line, sizeof(line), "%5zu  %.4f     %.4f (%.2e)        %.4f (%.2e)        %s\n", layer,
+                          baseline.layerMs[layer], half.layerMs[layer], half.maxDivergence,
+                          int8.layerMs[layer], int8.maxDivergence, NeuralBuffers::precisionName(policy[layer]));
+        }
+        std::cout << line;
+
+        const Evaluation& chosen = single[layer][static_cast<size_t>(policy[layer])];
+        std::ostringstream comment;
+        comment << formatMs(chosen.layerMs[layer]) << " (fp32 " << formatMs(baseline.layerMs[layer])
+                << "), alone max divergence " << chosen.maxDivergence;
+        comments.push_back(comment.str());
+
+        fp32Total += baseline.layerMs[layer];
+        policyTotal += combined.layerMs[layer];
+    }
+    std::cout << "\nfp32 " << formatMs(fp32Total) << ", policy " << formatMs(policyTotal)
+              << ", max divergence " << combined.maxDivergence << " (mean " << combined.meanDivergence
+              << ", budget " << options.budget << ")\n";
+
+    if (!NeuralBuffers::savePrecisionPolicy(options.outPath, policy, comments)) {
+        return 1;
+    }
+    std::cout << "[INFO] Precision policy written to " << options.outPath << "\n";
+    return 0;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Shared helpers for the model tools
+ */
+namespace tools {
+
+/**
+ * @brief Parse a decimal command-line integer within [minValue, maxValue]
+ * @return false for signs, non-digits, overflow or out-of-range values
+ */
+inline bool parseUnsigned(const std::string& text, uint64_t minValue, uint64_t maxValue, uint64_t& value) {
+    // stoull would accept "-1" (wrapping) and trailing garbage, so only plain digits get through
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    try {
+        const unsigned long long parsed = std::stoull(text);
+        if (parsed < minValue || parsed > maxValue) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    } catch (const std::invalid_argument&) {
+        return false;
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Parse a finite, non-negative command-line number (the whole string must be used)
+ */
+inline bool parseNonNegative(const std::string& text, double& value) {
+    try {
+        size_t used = 0;
+        const double parsed = std::stod(text, &used);
+        if (used != text.size() || !std::isfinite(parsed) || parsed < 0.0) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    } catch (const std::invalid_argument&) {
+        return false;
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Load a sample set of raw little-endian float32 inputs
+ * @param path Sample file (inputSize floats per sample); empty = generate
+ * @param count Number of uniform [0, 1) samples to generate without a file (seed 42)
+ * @param inputSize Floats per sample
+ * @param samples Loaded samples (a trailing partial sample is ignored)
+ */
+inline bool loadSamples(const std::string& path, uint32_t count, uint32_t inputSize,
+                        std::vector<std::vector<float>>& samples) {
+    if (path.empty()) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        samples.assign(std::max(1u, count), std::vector<float>(inputSize));
+        for (auto& sample : samples) {
+            for (float& v : sample) v = dist(rng);
+        }
+        return true;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "[ERROR] Failed to open samples: " << path << "\n";
+        return false;
+    }
+    std::vector<float> sample(inputSize);
+    while (file.read(reinterpret_cast<char*>(sample.data()), inputSize * sizeof(float))) {
+        samples.push_back(sample);
+    }
+    if (samples.empty()) {
+        std::cerr << "[ERROR] " << path << " holds no complete sample of " << inputSize << " floats\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace tools